@@ -0,0 +1,135 @@
+//*****************************************************************************
+//
+// backoff.c - Retry delays with exponential backoff and jitter.
+//
+// Copyright (c) 2015 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+//
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+//
+//*****************************************************************************
+
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "backoff.h"
+
+//*****************************************************************************
+//
+// State of the pseudo random number generator used for the jitter.  It must
+// be seeded with a value that differs between boards, or they will still
+// retry in step.
+//
+//*****************************************************************************
+static uint32_t g_ui32RandomState = 0x2545F491;
+
+//*****************************************************************************
+//
+// Seed the random number generator.  A seed of 0 is ignored, as the generator
+// would only ever return 0.
+//
+//*****************************************************************************
+void
+BackoffSeed(uint32_t ui32Seed)
+{
+    if(ui32Seed != 0)
+    {
+        g_ui32RandomState = ui32Seed;
+    }
+}
+
+//*****************************************************************************
+//
+// Returns the next pseudo random number (xorshift32).
+//
+//*****************************************************************************
+uint32_t
+BackoffRandom(void)
+{
+    uint32_t ui32X;
+
+    ui32X = g_ui32RandomState;
+    ui32X ^= ui32X << 13;
+    ui32X ^= ui32X >> 17;
+    ui32X ^= ui32X << 5;
+    g_ui32RandomState = ui32X;
+
+    return (ui32X);
+}
+
+//*****************************************************************************
+//
+// Change the base delay and the cap of a retry policy.  The base delay can't
+// be 0 and the cap can't be below the base delay.
+//
+//*****************************************************************************
+void
+BackoffConfig(tBackoff *psBackoff, uint32_t ui32BaseMs, uint32_t ui32CapMs)
+{
+    if(ui32BaseMs == 0)
+    {
+        ui32BaseMs = 1;
+    }
+    if(ui32CapMs < ui32BaseMs)
+    {
+        ui32CapMs = ui32BaseMs;
+    }
+
+    psBackoff->ui32BaseMs = ui32BaseMs;
+    psBackoff->ui32CapMs = ui32CapMs;
+}
+
+//*****************************************************************************
+//
+// Record a failure and return the delay before the next attempt.
+//
+//*****************************************************************************
+uint32_t
+BackoffNext(tBackoff *psBackoff)
+{
+    uint32_t ui32Limit;
+
+    //
+    // Double the base delay for each failure in a row, stopping at the cap
+    // without overflowing.
+    //
+    if((psBackoff->ui32Failures < 32) &&
+       ((psBackoff->ui32CapMs >> psBackoff->ui32Failures) >=
+        psBackoff->ui32BaseMs))
+    {
+        ui32Limit = psBackoff->ui32BaseMs << psBackoff->ui32Failures;
+    }
+    else
+    {
+        ui32Limit = psBackoff->ui32CapMs;
+    }
+
+    psBackoff->ui32Failures++;
+    psBackoff->ui32LastMs = BackoffRandom() % (ui32Limit + 1);
+
+    return (psBackoff->ui32LastMs);
+}
+
+//*****************************************************************************
+//
+// Record a success.  The next failure starts again from the base delay.
+//
+//*****************************************************************************
+void
+BackoffReset(tBackoff *psBackoff)
+{
+    psBackoff->ui32Failures = 0;
+    psBackoff->ui32LastMs = 0;
+}
@@ -0,0 +1,70 @@
+//*****************************************************************************
+//
+// backoff.h - Retry delays with exponential backoff and jitter.
+//
+// Copyright (c) 2015 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+//
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+//
+//*****************************************************************************
+
+
+
+#ifndef __BACKOFF_H__
+#define __BACKOFF_H__
+
+//*****************************************************************************
+//
+// Retry policy.  After the n-th failure in a row, the delay before the next
+// attempt is picked at random between 0 and the lower of the cap and the
+// base delay times 2^n ("full jitter"), so devices that failed at the same
+// time spread their retries instead of retrying in step.  The failure count
+// is reset by the first success.  Delays are in milliseconds.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // Name of the policy, shown on the console.
+    //
+    const char *pcName;
+
+    //
+    // Delay before the first retry and upper limit of the delay.
+    //
+    uint32_t ui32BaseMs;
+    uint32_t ui32CapMs;
+
+    //
+    // Number of failures in a row and the last delay returned.
+    //
+    uint32_t ui32Failures;
+    uint32_t ui32LastMs;
+} tBackoff;
+
+//*****************************************************************************
+//
+// Prototypes of the functions that are called from outside the backoff.c
+// module.
+//
+//*****************************************************************************
+extern void BackoffSeed(uint32_t ui32Seed);
+extern uint32_t BackoffRandom(void);
+extern void BackoffConfig(tBackoff *psBackoff, uint32_t ui32BaseMs,
+                          uint32_t ui32CapMs);
+extern uint32_t BackoffNext(tBackoff *psBackoff);
+extern void BackoffReset(tBackoff *psBackoff);
+
+#endif // __BACKOFF_H__
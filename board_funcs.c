@@ -26,6 +26,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <ti/drivers/GPIO.h>
+#include <ti/sysbios/knl/Swi.h>
 #include "inc/hw_adc.h"
 #include "inc/hw_memmap.h"
 #include "inc/hw_types.h"
@@ -53,6 +54,7 @@ uint32_t g_ui32SW2 = 0;
 void gpioSWFxn1(void)
 {
     g_ui32SW1++;
+    CloudNotify(CLOUD_EVENT_UPDATE);
 }
 
 //*****************************************************************************
@@ -63,6 +65,7 @@ void gpioSWFxn1(void)
 void gpioSWFxn2(void)
 {
     g_ui32SW2++;
+    CloudNotify(CLOUD_EVENT_UPDATE);
 }
 
 //*****************************************************************************
@@ -153,6 +156,13 @@ ReadInternalTemp(void)
 {
     uint32_t ui32Temperature;
     uint32_t ui32ADCValue;
+    UInt uiKey;
+
+    //
+    // This is also called from the telemetry sampler clock function, so keep
+    // clock functions from running until the conversion is read.
+    //
+    uiKey = Swi_disable();
 
     //
     // Take a temperature reading with the ADC.
@@ -176,6 +186,8 @@ ReadInternalTemp(void)
     //
     ADCSequenceDataGet(ADC0_BASE, 3, &ui32ADCValue);
 
+    Swi_restore(uiKey);
+
     //
     // Convert the measurement to degrees Celcius.
     //
@@ -307,6 +319,214 @@ SaveCIKEEPROM(char *pcProvBuf)
     return true;
 }
 
+//*****************************************************************************
+//
+// Get/Read the TLS session saved by SaveTLSSessionEEPROM().  pui8Buf must be
+// word aligned and hold TLS_SESSION_MAX_LENGTH bytes.  Returns false if no
+// valid session is stored.
+//
+//*****************************************************************************
+bool
+GetTLSSessionEEPROM(uint8_t *pui8Buf, uint32_t *pui32Len,
+                    uint32_t *pui32Expiry)
+{
+    uint32_t pui32Header[2];
+
+    //
+    // Read the length and expiry of the stored session.
+    //
+    EEPROMRead(pui32Header, (uint32_t)(TLS_SESSION_OFFSET),
+               sizeof(pui32Header));
+
+    //
+    // An erased EEPROM reads back as all ones.  Check that the length is
+    // sane before reading the session itself.
+    //
+    if((pui32Header[0] == 0) || (pui32Header[0] > TLS_SESSION_MAX_LENGTH))
+    {
+        return false;
+    }
+
+    //
+    // Read the session.
+    //
+    EEPROMRead((uint32_t *)pui8Buf,
+               (uint32_t)(TLS_SESSION_OFFSET + sizeof(pui32Header)),
+               (pui32Header[0] + 3) & ~3);
+
+    *pui32Len = pui32Header[0];
+    *pui32Expiry = pui32Header[1];
+
+    //
+    // Return Success.
+    //
+    return true;
+}
+
+//*****************************************************************************
+//
+// Save/Write a serialized TLS session and its expiry to EEPROM.  pui8Buf must
+// be word aligned and padded to a multiple of 4 bytes.  A length of zero
+// invalidates the stored session.
+//
+//*****************************************************************************
+bool
+SaveTLSSessionEEPROM(uint8_t *pui8Buf, uint32_t ui32Len, uint32_t ui32Expiry)
+{
+    uint32_t pui32Header[2];
+
+    //
+    // Check if the session fits in the space reserved for it.
+    //
+    if(ui32Len > TLS_SESSION_MAX_LENGTH)
+    {
+        return false;
+    }
+
+    //
+    // Invalidate the stored session before overwriting it, and write the
+    // header last, so that an interrupted write never leaves a valid length
+    // in front of a partial session.
+    //
+    pui32Header[0] = 0;
+    pui32Header[1] = 0;
+    if(EEPROMProgram(pui32Header, (uint32_t)(TLS_SESSION_OFFSET),
+                     sizeof(pui32Header)) != 0)
+    {
+        return false;
+    }
+    if(ui32Len == 0)
+    {
+        return true;
+    }
+    if(EEPROMProgram((uint32_t *)pui8Buf,
+                     (uint32_t)(TLS_SESSION_OFFSET + sizeof(pui32Header)),
+                     (ui32Len + 3) & ~3) != 0)
+    {
+        return false;
+    }
+
+    pui32Header[0] = ui32Len;
+    pui32Header[1] = ui32Expiry;
+    if(EEPROMProgram(pui32Header, (uint32_t)(TLS_SESSION_OFFSET),
+                     sizeof(pui32Header)) != 0)
+    {
+        return false;
+    }
+
+    //
+    // Return Success.
+    //
+    return true;
+}
+
+//*****************************************************************************
+//
+// Labels that define the value that marks a valid outbox header in EEPROM
+// and the size of the header in front of the records.
+//
+//*****************************************************************************
+#define OUTBOX_MAGIC            0x4F425831
+#define OUTBOX_HEADER_SIZE      16
+
+//*****************************************************************************
+//
+// Get/Read the head and tail record counts of the outbox saved by
+// SaveOutboxEEPROM().  Returns false if no valid outbox is stored, which is
+// the case after an erase or if a header write was interrupted.
+//
+//*****************************************************************************
+bool
+GetOutboxEEPROM(uint32_t *pui32Head, uint32_t *pui32Tail)
+{
+    uint32_t pui32Header[OUTBOX_HEADER_SIZE / 4];
+
+    EEPROMRead(pui32Header, (uint32_t)(OUTBOX_OFFSET), sizeof(pui32Header));
+
+    if((pui32Header[0] != OUTBOX_MAGIC) ||
+       (pui32Header[3] != (OUTBOX_MAGIC ^ pui32Header[1] ^ pui32Header[2])) ||
+       ((pui32Header[1] - pui32Header[2]) > OUTBOX_RECORDS))
+    {
+        return false;
+    }
+
+    *pui32Head = pui32Header[1];
+    *pui32Tail = pui32Header[2];
+
+    //
+    // Return Success.
+    //
+    return true;
+}
+
+//*****************************************************************************
+//
+// Save/Write the head and tail record counts of the outbox to EEPROM.  This
+// must be done after the records themselves are written, so that the header
+// never covers a record that is not stored yet.
+//
+//*****************************************************************************
+bool
+SaveOutboxEEPROM(uint32_t ui32Head, uint32_t ui32Tail)
+{
+    uint32_t pui32Header[OUTBOX_HEADER_SIZE / 4];
+
+    pui32Header[0] = OUTBOX_MAGIC;
+    pui32Header[1] = ui32Head;
+    pui32Header[2] = ui32Tail;
+    pui32Header[3] = OUTBOX_MAGIC ^ ui32Head ^ ui32Tail;
+    if(EEPROMProgram(pui32Header, (uint32_t)(OUTBOX_OFFSET),
+                     sizeof(pui32Header)) != 0)
+    {
+        return false;
+    }
+
+    //
+    // Return Success.
+    //
+    return true;
+}
+
+//*****************************************************************************
+//
+// Get/Read an outbox record.  ui32Index is a record count, which wraps around
+// the ring.  pui32Record must hold OUTBOX_RECORD_SIZE bytes.
+//
+//*****************************************************************************
+void
+ReadOutboxRecordEEPROM(uint32_t ui32Index, uint32_t *pui32Record)
+{
+    EEPROMRead(pui32Record,
+               (uint32_t)(OUTBOX_OFFSET + OUTBOX_HEADER_SIZE +
+                          ((ui32Index % OUTBOX_RECORDS) *
+                           OUTBOX_RECORD_SIZE)),
+               OUTBOX_RECORD_SIZE);
+}
+
+//*****************************************************************************
+//
+// Save/Write an outbox record.  ui32Index is a record count, which wraps
+// around the ring.  pui32Record holds OUTBOX_RECORD_SIZE bytes.
+//
+//*****************************************************************************
+bool
+SaveOutboxRecordEEPROM(uint32_t ui32Index, uint32_t *pui32Record)
+{
+    if(EEPROMProgram(pui32Record,
+                     (uint32_t)(OUTBOX_OFFSET + OUTBOX_HEADER_SIZE +
+                                ((ui32Index % OUTBOX_RECORDS) *
+                                 OUTBOX_RECORD_SIZE)),
+                     OUTBOX_RECORD_SIZE) != 0)
+    {
+        return false;
+    }
+
+    //
+    // Return Success.
+    //
+    return true;
+}
+
 //*****************************************************************************
 //
 // Erase EEPROM.  This will erase everything including the CIK.
@@ -31,6 +31,28 @@
 //*****************************************************************************
 #define EXOSITE_CIK_OFFSET      0
 
+//*****************************************************************************
+//
+// Labels that define the EEPROM offset and maximum size of the stored TLS
+// session.  The session is stored as a length word, an expiry word (seconds
+// since epoch) and the serialized session padded to a multiple of 4 bytes.
+//
+//*****************************************************************************
+#define TLS_SESSION_OFFSET      64
+#define TLS_SESSION_MAX_LENGTH  512
+
+//*****************************************************************************
+//
+// Labels that define the EEPROM offset and size of the telemetry outbox.  The
+// outbox is stored as a header of a magic word, the head and tail record
+// counts and a check word, followed by a ring of OUTBOX_RECORDS records of
+// OUTBOX_RECORD_SIZE bytes each.  OUTBOX_RECORDS must be a power of 2.
+//
+//*****************************************************************************
+#define OUTBOX_OFFSET           1024
+#define OUTBOX_RECORD_SIZE      16
+#define OUTBOX_RECORDS          256
+
 //*****************************************************************************
 //
 // Prototypes of the functions that are called from outside the board_funcs.c
@@ -45,5 +67,13 @@ extern bool GetMacAddress(char *pcMACAddress, uint32_t ui32MACLen);
 extern void InitEEPROM(void);
 extern bool GetCIKEEPROM(char *pcProvBuf);
 extern bool SaveCIKEEPROM(char *pcProvBuf);
+extern bool GetTLSSessionEEPROM(uint8_t *pui8Buf, uint32_t *pui32Len,
+                                uint32_t *pui32Expiry);
+extern bool SaveTLSSessionEEPROM(uint8_t *pui8Buf, uint32_t ui32Len,
+                                 uint32_t ui32Expiry);
+extern bool GetOutboxEEPROM(uint32_t *pui32Head, uint32_t *pui32Tail);
+extern bool SaveOutboxEEPROM(uint32_t ui32Head, uint32_t ui32Tail);
+extern void ReadOutboxRecordEEPROM(uint32_t ui32Index, uint32_t *pui32Record);
+extern bool SaveOutboxRecordEEPROM(uint32_t ui32Index, uint32_t *pui32Record);
 
 #endif // __BOARD_FUNC_H__
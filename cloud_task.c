@@ -26,23 +26,37 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include <xdc/std.h>
 #include <ti/drivers/GPIO.h>
 #include <ti/net/http/httpcli.h>
 #include <ti/net/http/sswolfssl.h>
 #include <ti/sysbios/BIOS.h>
 #include <ti/sysbios/knl/Clock.h>
+#include <ti/sysbios/knl/Event.h>
 #include <ti/sysbios/knl/Task.h>
 #include <xdc/cfg/global.h>
 #include <xdc/runtime/Error.h>
 #include <xdc/runtime/System.h>
 #include "Board.h"
+#include "backoff.h"
 #include "board_funcs.h"
 #include "certificate.h"
 #include "cloud_task.h"
 #include "command_task.h"
+#include "latency.h"
+#include "connect_race.h"
+#include "dns_cache.h"
+#include "endpoint.h"
+#include "fast_format.h"
+#include "form_parser.h"
 #include "ntp_time.h"
 #include "priorities.h"
+#include "send_buffer.h"
+#include "telemetry.h"
 #include "tictactoe.h"
+#include "url_codec.h"
 
 //*****************************************************************************
 //
@@ -60,6 +74,14 @@
 //*****************************************************************************
 #define BIOS_TICK_RATE          1000
 
+//*****************************************************************************
+//
+// Stack size of the long-poll task.  Like the Cloud task, it needs a big stack
+// for WolfSSL function calls.
+//
+//*****************************************************************************
+#define STACK_LONGPOLL_TASK     20000
+
 //*****************************************************************************
 //
 // Defines used by POST and GET requests.
@@ -71,6 +93,106 @@
 #define EXOSITE_CONTENT_TYPE    "application/x-www-form-urlencoded; "         \
                                 "charset=utf-8"
 #define EXOSITE_TYPE            "X-Exosite-CIK"
+#define EXOSITE_REQUEST_TIMEOUT "Request-Timeout"
+#define EXOSITE_RPC_URI         "/onep:v1/rpc/process"
+#define EXOSITE_JSON_TYPE       "application/json; charset=utf-8"
+
+//*****************************************************************************
+//
+// Size of the buffer that holds the request headers sent after the request
+// line.
+//
+//*****************************************************************************
+#define HEADER_BLOCK_SIZE       256
+
+//*****************************************************************************
+//
+// Defines used to manage the persistent connection to the server.  A
+// connection is replaced before the server is expected to close it, allowing
+// KEEPALIVE_MARGIN_MS for the next request to reach the server.
+//
+//*****************************************************************************
+#define KEEPALIVE_UNLIMITED     0xFFFFFFFF
+#define KEEPALIVE_MARGIN_MS     500
+
+//*****************************************************************************
+//
+// Only the aliases whose value changed are written to the server, but all of
+// them are written again every FULL_REFRESH_PERIOD seconds in case a write
+// was lost.
+//
+//*****************************************************************************
+#define FULL_REFRESH_PERIOD     60
+
+//*****************************************************************************
+//
+// Default base delay and cap, in milliseconds, of the retry policies.
+//
+//*****************************************************************************
+#define CONNECT_BACKOFF_BASE    1000
+#define CONNECT_BACKOFF_CAP     120000
+#define SERVER_BACKOFF_BASE     2000
+#define SERVER_BACKOFF_CAP      300000
+#define LONGPOLL_BACKOFF_BASE   1000
+#define LONGPOLL_BACKOFF_CAP    120000
+
+//*****************************************************************************
+//
+// Sync schedule, in milliseconds.  Syncs happen once per SYNC_PERIOD at an
+// offset into the period that is derived from the MAC address, plus up to
+// SYNC_JITTER at random, so that boards powered up together don't reach the
+// server at the same instant.  The first connect after boot is spread the
+// same way over STARTUP_SPREAD.
+//
+//*****************************************************************************
+#define SYNC_PERIOD             1000
+#define SYNC_JITTER             50
+#define STARTUP_SPREAD          10000
+
+//*****************************************************************************
+//
+// Range of the sync period that the server can set with the "syncperiod"
+// alias, in milliseconds.
+//
+//*****************************************************************************
+#define SYNC_PERIOD_MIN         1000
+#define SYNC_PERIOD_MAX         3600000
+
+//*****************************************************************************
+//
+// Status returned by a server that is shedding load, and the largest delay in
+// seconds that is accepted from its Retry-After header.
+//
+//*****************************************************************************
+#define HTTP_TOO_MANY_REQUESTS  429
+#define RETRY_AFTER_MAX         3600
+
+//*****************************************************************************
+//
+// Time in milliseconds an endpoint is demoted for after it failed repeatedly.
+// It grows with every further failure.
+//
+//*****************************************************************************
+#define ENDPOINT_HOLD_MS        30000
+
+//*****************************************************************************
+//
+// Index of the response header fields in g_ppcResponseFields.
+//
+//*****************************************************************************
+#define RESPONSE_FIELD_CONNECTION       0
+#define RESPONSE_FIELD_KEEP_ALIVE       1
+#define RESPONSE_FIELD_ETAG             2
+#define RESPONSE_FIELD_LAST_MODIFIED    3
+#define RESPONSE_FIELD_RETRY_AFTER      4
+
+//*****************************************************************************
+//
+// Size of the buffers that hold the ETag and Last-Modified validators of the
+// last read, including the terminating 0.  Longer validators are not used.
+//
+//*****************************************************************************
+#define VALIDATOR_SIZE          64
 
 //*****************************************************************************
 //
@@ -79,6 +201,19 @@
 //*****************************************************************************
 static char g_pcExositeCIK[EXOSITE_CIK_LENGTH + 1];
 
+//*****************************************************************************
+//
+// Global resources to hold the request headers that only change with the CIK.
+// The block holds the X-Exosite-CIK and Accept headers used by every request,
+// followed by the Content-Type header used by requests with a body.  It is
+// rebuilt when g_pcExositeCIK no longer matches g_pcHeaderCIK.
+//
+//*****************************************************************************
+static char g_pcHeaderBlock[HEADER_BLOCK_SIZE];
+static char g_pcHeaderCIK[EXOSITE_CIK_LENGTH + 1];
+static uint32_t g_ui32HeaderReadLen;
+static uint32_t g_ui32HeaderWriteLen;
+
 //*****************************************************************************
 //
 // Global resource to store MAC Address.
@@ -115,30 +250,19 @@ HTTPCli_Field g_psFields[2] =
 
 //*****************************************************************************
 //
-// The alias sent to Exosite server with POST request.
-//
-//*****************************************************************************
-const char g_ppcPOSTAlias[7][15] =
-{
-    "usrsw1",
-    "usrsw2",
-    "jtemp",
-    "ontime",
-    "gamestate",
-    "ledd1",
-    "emailaddr"
-};
-
-//*****************************************************************************
-//
-// The alias values requested from Exosite server with GET request.
+// The response header fields that are returned by HTTPCli_getResponseField().
+// All other fields are dropped.  The order must match the RESPONSE_FIELD_*
+// labels.
 //
 //*****************************************************************************
-const char g_ppcGETAlias[ALIAS_PROCESSING][15] =
+const char *g_ppcResponseFields[] =
 {
-    "ledd1",
-    "emailaddr",
-    "gamestate"
+    "Connection",
+    "Keep-Alive",
+    "ETag",
+    "Last-Modified",
+    "Retry-After",
+    NULL
 };
 
 //*****************************************************************************
@@ -188,852 +312,3189 @@ tReadWriteType g_eAlertRW = NONE;
 
 //*****************************************************************************
 //
-// Global resource to hold cloud connection states.
+// Read/write mode of the aliases that are only ever written or only ever
+// read.
 //
 //*****************************************************************************
-tCloudState g_ui32State = Cloud_Idle;
+static tReadWriteType g_eSensorRW = WRITE_ONLY;
+static tReadWriteType g_eLocationRW = READ_ONLY;
+static tReadWriteType g_eSyncRW = READ_ONLY;
 
 //*****************************************************************************
 //
-// Global resource to indicate the state of the connection to the cloud server.
+// Global resources to hold the sync settings owned by the server.  The sync
+// period is in milliseconds, 0 selects SYNC_PERIOD.  The sync mask enables
+// the writing of each alias, by the <sync bit> given in ALIAS_TABLE.  They
+// let the server shed load across the fleet.
 //
 //*****************************************************************************
-bool g_bServerConnect = false;
+uint32_t g_ui32SyncPeriod = 0;
+uint32_t g_ui32SyncMask = 0xFFFFFFFF;
 
 //*****************************************************************************
 //
-// Global resource to hold IP address and proxy setting.
+// Global resources to hold the 95th percentile of the duration of each phase
+// of the requests, as posted to the server, and its read/write mode.  It is
+// only posted when enabled from the console.
 //
 //*****************************************************************************
-#ifdef SET_PROXY
-char g_pcIP[50] = PROXY_ADDR;
-bool g_bProxy = 1;
-#else
-char g_pcIP[50] = EXOSITE_ADDR;
-bool g_bProxy = 0;
-#endif
+char g_pcLatencies[100];
+tReadWriteType g_eLatenciesRW = NONE;
 
 //*****************************************************************************
 //
-// This function creates a HTTP client instance and connect to the Exosite
-// Server.
+// Functions that read the value of the sensor aliases.
 //
 //*****************************************************************************
-int32_t
-ServerConnect(HTTPCli_Handle cli)
-{
-    int32_t i32Ret = 0;
-    struct sockaddr_in sSockAddr;
-    uint32_t ui32Retry = 0;
-    char * pcDebug;
+static uint32_t ReadSwitch1(void);
+static uint32_t ReadSwitch2(void);
+static uint32_t ReadTemp(void);
+uint32_t ReadOnTime(void);
 
-    g_sDebug.ui32Request = Cmd_Prompt_Print;
-    pcDebug = g_sDebug.pcBuf;
+//*****************************************************************************
+//
+// The aliases exchanged with the Exosite server.  Each line declares one
+// alias as follows.
+//
+// ALIAS(<id>, <name>, <type>, <read function>, <storage>, <read/write mode>,
+//       <flags>, <sync bit>)
+//
+// <type> selects how the value is formatted and parsed, see tAliasType.
+// Numeric aliases take their value from <read function> if it is not NULL,
+// or else from the uint32_t pointed to by <storage>.  String aliases are
+// stored in the char array <storage>.  Values read from the server are only
+// stored if <read/write mode> is READ_ONLY.  An alias is requested from the
+// server while its mode is READ_ONLY and written while it is READ_WRITE or
+// WRITE_ONLY.  A READ_WRITE alias is written once, after which it becomes
+// READ_ONLY, or NONE if it has the ALIAS_EVENT flag.  <sync bit> is the bit
+// of g_ui32SyncMask that enables the writing of the alias.  The server
+// relies on these bits, so an alias keeps its bit when aliases are added or
+// removed, and a new alias takes a bit that was never used.
+//
+// The generated identifier ALIAS_<id> is the index of the alias in
+// g_psAliases and the bit of the alias in tRequestBody.ui32Dirty.
+//
+//*****************************************************************************
+#define ALIAS_TABLE                                                           \
+    ALIAS(USRSW1,    "usrsw1",    Alias_Decimal, ReadSwitch1, NULL,           \
+          &g_eSensorRW,    ALIAS_SAMPLED,   0)                                \
+    ALIAS(USRSW2,    "usrsw2",    Alias_Decimal, ReadSwitch2, NULL,           \
+          &g_eSensorRW,    ALIAS_SAMPLED,   1)                                \
+    ALIAS(JTEMP,     "jtemp",     Alias_Decimal, ReadTemp,    NULL,           \
+          &g_eSensorRW,    ALIAS_SAMPLED,   2)                                \
+    ALIAS(ONTIME,    "ontime",    Alias_Decimal, ReadOnTime,  NULL,           \
+          &g_eSensorRW,    ALIAS_PIGGYBACK, 3)                                \
+    ALIAS(GAMESTATE, "gamestate", Alias_Hex,     NULL, &g_ui32BoardState,     \
+          &g_eBoardStaeRW, 0,               4)                                \
+    ALIAS(LEDD1,     "ledd1",     Alias_Flag,    NULL, &g_ui32LEDD1,          \
+          &g_eLEDD1RW,     0,               5)                                \
+    ALIAS(EMAILADDR, "emailaddr", Alias_String,  NULL, g_pcEmail,             \
+          &g_eEmailRW,     0,               6)                                \
+    ALIAS(ALERT,     "alert",     Alias_String,  NULL, g_pcAlert,             \
+          &g_eAlertRW,     ALIAS_EVENT,     7)                                \
+    ALIAS(LOCATION,  "location",  Alias_None,    NULL, NULL,                  \
+          &g_eLocationRW,  0,               8)                                \
+    ALIAS(SYNCPERIOD, "syncperiod", Alias_Decimal, NULL, &g_ui32SyncPeriod,   \
+          &g_eSyncRW,      0,               9)                                \
+    ALIAS(SYNCMASK,  "syncmask",  Alias_Hex,     NULL, &g_ui32SyncMask,       \
+          &g_eSyncRW,      0,               10)                               \
+    ALIAS(LATENCIES, "latencies", Alias_String,  NULL, g_pcLatencies,         \
+          &g_eLatenciesRW, 0,               11)
 
+//*****************************************************************************
+//
+// How the value of an alias is formatted and parsed.
+//
+//*****************************************************************************
+typedef enum
+{
     //
-    // Set-up a socket to communicate with Exosite server.
+    // Value that is never used.
     //
-    i32Ret = HTTPCli_initSockAddr((struct sockaddr *)&sSockAddr,
-                                  g_pcIP, 0);
-    if(i32Ret != 0)
-    {
-        //
-        // Failed to create socket.  Report error and return.
-        //
-        snprintf(pcDebug, TX_BUF_SIZE, "Failed to resolve host name. Check "
-                 "proxy server settings. Ecode: %d.\n", i32Ret);
-        Mailbox_post(CloudMailbox, &g_sDebug, BIOS_NO_WAIT);
-        System_printf(pcDebug);
-        return (-1);
-    }
-
-    if(g_bProxy == true)
-    {
-        //
-        // If proxy settings are needed, set them here.
-        //
-        HTTPCli_setProxy((struct sockaddr *)&sSockAddr);
-    }
-
-    g_sDebug.ui32Request = Cmd_Prompt_No_Print;
-    snprintf(pcDebug, TX_BUF_SIZE, "Connecting to server...");
-    Mailbox_post(CloudMailbox, &g_sDebug, 100);
-    System_printf(pcDebug);
-    System_printf("\n");
-    g_sDebug.ui32Request = Cmd_Prompt_Print;
-
-    while(ui32Retry < 5)
-    {
-        //
-        // Create an HTTP client instance.
-        //
-        HTTPCli_construct(cli);
-
-        //
-        // Set-up headers that are to be sent automatically with GET/POST
-        // request.
-        //
-        HTTPCli_setRequestFields(cli, g_psFields);
-
-        //
-        // Connect a socket to Exosite server in secure mode.
-        //
-        i32Ret = HTTPCli_connect(cli, (struct sockaddr *)&sSockAddr,
-                                 HTTPCli_TYPE_TLS, NULL);
-        if(i32Ret == 0)
-        {
-            //
-            // Success.  Return from the loop.
-            //
-            snprintf(pcDebug, TX_BUF_SIZE, "Connected to Exosite server.\n");
-            Mailbox_post(CloudMailbox, &g_sDebug, 100);
-            System_printf(pcDebug);
-            return (0);
-        }
-        else
-        {
-            //
-            // If we failed to connect, display this information and try for
-            // a few more times.
-            //
-            g_sDebug.ui32Request = Cmd_Prompt_No_Print;
-            snprintf(pcDebug, TX_BUF_SIZE, "Failed to connect to server, "
-                     "ecode: %d. Retrying...", i32Ret);
-            Mailbox_post(CloudMailbox, &g_sDebug, BIOS_NO_WAIT);
-            System_printf(pcDebug);
-            g_sDebug.ui32Request = Cmd_Prompt_Print;
+    Alias_None,
 
-            ui32Retry ++;
+    //
+    // Unsigned decimal number.
+    //
+    Alias_Decimal,
 
-            //
-            // Deconstruct the HTTP client instance.
-            //
-            HTTPCli_destruct(cli);
+    //
+    // Unsigned number, written in hexadecimal.
+    //
+    Alias_Hex,
 
-            //
-            // Sleep for a sec between each trial.
-            //
-            Task_sleep(1000);
-        }
-    }
+    //
+    // 0 or 1.
+    //
+    Alias_Flag,
 
     //
-    // Failed to connect so return with error.
+    // 0 terminated string.
     //
-    snprintf(pcDebug, TX_BUF_SIZE, "Failed to connect to server after 5 "
-             "trials.\n");
-    Mailbox_post(CloudMailbox, &g_sDebug, BIOS_NO_WAIT);
-    System_printf(pcDebug);
-    return -1;
-}
+    Alias_String
+} tAliasType;
 
 //*****************************************************************************
 //
-// Disconnect from the Exosite Server and destroy the HTTP client instance.
+// Alias flags.  ALIAS_SAMPLED aliases are not written while they are uploaded
+// in batches by ExositeRecord().  ALIAS_PIGGYBACK aliases are only written
+// along with another alias.  ALIAS_EVENT aliases are never read back.
 //
 //*****************************************************************************
-void
-ServerDisconnect(HTTPCli_Handle cli)
-{
-    HTTPCli_disconnect(cli);
-}
+#define ALIAS_SAMPLED           0x00000001
+#define ALIAS_PIGGYBACK         0x00000002
+#define ALIAS_EVENT             0x00000004
 
 //*****************************************************************************
 //
-// Disconnect and Connect back to the Exosite Server.
+// Description of an alias, as generated from ALIAS_TABLE.
 //
 //*****************************************************************************
-void
-ServerReconnect(HTTPCli_Handle cli)
+typedef struct
 {
-    ServerDisconnect(cli);
-    ServerConnect(cli);
-}
+    const char *pcName;
+    tAliasType eType;
+    uint32_t (*pfnRead)(void);
+    void *pvStorage;
+    uint32_t ui32Size;
+    tReadWriteType *peRW;
+    uint32_t ui32Flags;
+    uint32_t ui32SyncBit;
+} tAlias;
 
 //*****************************************************************************
 //
-// This function tries to read a CIK from non-volatile memory and reports if
-// one if found or not.  If a CIK is present in NVM then it is copied to global
-// resource.
+// Index of each alias in g_psAliases.
 //
 //*****************************************************************************
-bool
-GetCIK(HTTPCli_Handle cli)
+#define ALIAS(id, name, type, read, storage, rw, flags, bit)                 \
+    ALIAS_##id,
+enum
 {
-    char pcCIK[EXOSITE_CIK_LENGTH + 1];
-    char * pcDebug;
-
-    g_sDebug.ui32Request = Cmd_Prompt_Print;
-    pcDebug = g_sDebug.pcBuf;
-
-    if(GetCIKEEPROM(pcCIK) == true)
-    {
-        if(pcCIK != NULL)
-        {
-            //
-            // CIK Found.  Update the global resource with CIK found in NVM.
-            //
-            memcpy(g_pcExositeCIK, pcCIK, EXOSITE_CIK_LENGTH + 1);
-
-            //
-            // Report this to user.
-            //
-            snprintf(pcDebug, TX_BUF_SIZE, "CIK found in EEPROM %s\n",
-                     g_pcExositeCIK);
-            Mailbox_post(CloudMailbox, &g_sDebug, BIOS_NO_WAIT);
-            System_printf(pcDebug);
-
-            //
-            // Return success.
-            //
-            return true;
-        }
-    }
-
-    //
-    // CIK not found. Report this.
-    //
-    snprintf(pcDebug, TX_BUF_SIZE, "No CIK found in EEPROM.\n");
-    Mailbox_post(CloudMailbox, &g_sDebug, BIOS_NO_WAIT);
-    System_printf(pcDebug);
-
-    //
-    // Return failure.
-    //
-    return false;
-}
+    ALIAS_TABLE
+    NUM_ALIASES
+};
+#undef ALIAS
 
 //*****************************************************************************
 //
-// Set the proxy value if requested by the user.
+// The table of aliases.
 //
 //*****************************************************************************
-void
-CloudProxySet(HTTPCli_Handle cli, char *pcProxy)
+#define ALIAS(id, name, type, read, storage, rw, flags, bit)                 \
+    { name, type, read, storage, sizeof(storage), rw, flags, bit },
+static const tAlias g_psAliases[NUM_ALIASES] =
 {
-    char * pcPort;
-
-    //
-    // Check if the buffer has proxy address.
-    //
-    if(pcProxy == NULL)
-    {
-        //
-        // No - Return without doing anything.
-        //
-        g_ui32State = Cloud_Idle;
-        return;
-    }
-
-    //
-    // Check if a port number was passed.
-    //
-    pcPort = strstr(pcProxy, ":");
-    if(pcPort == NULL)
-    {
-        //
-        // No - Return without doing anything.
-        //
-        g_ui32State = Cloud_Idle;
-        return;
-    }
-
-    //
-    // Copy the proxy address to global resource
-    //
-    strncpy(g_pcIP, pcProxy, 50);
+    ALIAS_TABLE
+};
+#undef ALIAS
 
-    //
-    // Set the global proxy flag.
-    //
-    g_bProxy = 1;
+//*****************************************************************************
+//
+// Hash table used to find an alias by name.  Each slot holds the index of an
+// alias in g_psAliases plus 1, or 0 if it is empty.  The hash function is
+// chosen so that none of the aliases share a slot, AliasTableInit() reports it
+// if a new alias breaks that.
+//
+//*****************************************************************************
+#define ALIAS_HASH_SIZE         32
+#define ALIAS_HASH(len, first, last)                                          \
+    ((((len) * 2) + (first) + (last)) & (ALIAS_HASH_SIZE - 1))
+static uint8_t g_pui8AliasHash[ALIAS_HASH_SIZE];
 
-    return;
-}
 
 //*****************************************************************************
 //
-// Populate the request body for a POST request to get the CIK.  The request
-// body will have the provisioning information that Exosite server seeks.
+// Alias of the sensor readings that are uploaded in batches by
+// ExositeRecord(), in the order they are written by WriteRecordBody().
 //
 //*****************************************************************************
-int32_t
-BuildProvInfo(const char *pcVendorName, const char *pcBoard,
-              char *pui8MACAddress, char *pcProvBuf, uint32_t ui32ProvBufLen)
+#define RECORD_ALIASES          3
+static const uint32_t g_pui32RecordAlias[RECORD_ALIASES] =
 {
-    uint32_t ui32BufLen = 0;
+    ALIAS_JTEMP,
+    ALIAS_USRSW1,
+    ALIAS_USRSW2
+};
 
+//*****************************************************************************
+//
+// Global resource to hold cloud connection states.
+//
+//*****************************************************************************
+tCloudState g_ui32State = Cloud_Idle;
+
+//*****************************************************************************
+//
+// Global resource to indicate the state of the connection to the cloud server.
+//
+//*****************************************************************************
+bool g_bServerConnect = false;
+
+//*****************************************************************************
+//
+// Global resource to hold the way data is exchanged with the cloud server.
+//
+//*****************************************************************************
+tSyncMode g_eSyncMode = Sync_Combined;
+
+//*****************************************************************************
+//
+// Global resource to hold the time taken by the sync cycles of each mode.
+//
+//*****************************************************************************
+tSyncStats g_psSyncStats[NUM_SYNC_MODES];
+
+//*****************************************************************************
+//
+// Global resource to hold the routes to the server, by the ENDPOINT_* labels,
+// and the index of the one the Cloud task is connected through.
+//
+//*****************************************************************************
+#ifndef SET_PROXY
+#define PROXY_ADDR              ""
+#endif
+tEndpoint g_psEndpoints[NUM_ENDPOINTS] =
+{
+    [ENDPOINT_DIRECT] =
+    {
+        .pcName = "direct",
+        .pcAddr = EXOSITE_ADDR,
+        .bProxy = false
+    },
+    [ENDPOINT_PROXY] =
+    {
+        .pcName = "proxy",
+        .pcAddr = PROXY_ADDR,
+        .bProxy = true
+    },
+    [ENDPOINT_ALTERNATE] =
+    {
+        .pcName = "alternate",
+        .pcAddr = EXOSITE_ALT_ADDR,
+        .bProxy = false
+    }
+};
+static uint32_t g_ui32Endpoint = ENDPOINT_DIRECT;
+
+//*****************************************************************************
+//
+// Timer of the phases of the connects and requests of the Cloud task.
+//
+//*****************************************************************************
+static tLatencyTimer g_sLatencyTimer;
+
+//*****************************************************************************
+//
+// The state of the persistent connection to the server, as reported by the
+// server in the Connection and Keep-Alive response headers.
+//
+//*****************************************************************************
+typedef struct
+{
     //
-    // Build the request body for provisioning.
+    // The server will close the connection after the last response.
     //
-    ui32BufLen = snprintf(pcProvBuf, ui32ProvBufLen, "%s=%s",
-                          g_ppcProvAlias[0], pcVendorName);
-    ui32BufLen += snprintf((pcProvBuf + ui32BufLen),
-                           (ui32ProvBufLen - ui32BufLen), "&%s=%s",
-                           g_ppcProvAlias[1], pcBoard);
-    ui32BufLen += snprintf((pcProvBuf + ui32BufLen),
-                           (ui32ProvBufLen - ui32BufLen), "&%s=%s",
-                           g_ppcProvAlias[2], pui8MACAddress);
+    bool bClose;
 
     //
-    // Indicate Success.
+    // Number of requests the server will still accept on this connection, or
+    // KEEPALIVE_UNLIMITED if not known.
     //
-    return 0;
+    uint32_t ui32Remaining;
+
+    //
+    // Idle timeout of the connection in seconds, or 0 if not known.
+    //
+    uint32_t ui32Timeout;
+
+    //
+    // Delay in seconds that the server asked for with the last response
+    // before it is sent another request, or 0 if none.
+    //
+    uint32_t ui32RetryAfter;
+
+    //
+    // Clock ticks when the last response was received.
+    //
+    uint32_t ui32LastTicks;
+} tKeepAlive;
+
+static tKeepAlive g_sKeepAlive;
+
+//*****************************************************************************
+//
+// Retry policies, by the BACKOFF_* labels, and the clock ticks before which
+// the Cloud task does not try to reach the server again.
+//
+//*****************************************************************************
+tBackoff g_psBackoff[NUM_BACKOFFS] =
+{
+    { "connect",  CONNECT_BACKOFF_BASE,  CONNECT_BACKOFF_CAP,  0, 0 },
+    { "server",   SERVER_BACKOFF_BASE,   SERVER_BACKOFF_CAP,   0, 0 },
+    { "longpoll", LONGPOLL_BACKOFF_BASE, LONGPOLL_BACKOFF_CAP, 0, 0 }
+};
+static uint32_t g_ui32RetryTicks;
+
+
+//*****************************************************************************
+//
+// Validators returned by the server with the last successful read.  They are
+// sent back with the next read of the same aliases as If-None-Match and
+// If-Modified-Since, so the server can respond with 304 Not Modified and no
+// body when none of the values changed.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // Aliases requested by the read the validators belong to, as a bit mask
+    // by index in g_psAliases.  This is 0 if there are no validators.
+    //
+    uint32_t ui32Aliases;
+
+    //
+    // Values of the ETag and Last-Modified response headers, or empty
+    // strings if the server did not send them.
+    //
+    char pcETag[VALIDATOR_SIZE];
+    char pcLastModified[VALIDATOR_SIZE];
+} tReadValidator;
+
+static tReadValidator g_sReadValidator;
+
+//*****************************************************************************
+//
+// Aliases requested by the read whose response has not been read yet, as a
+// bit mask by index in g_psAliases.
+//
+//*****************************************************************************
+static uint32_t g_ui32ReadAliases;
+
+//*****************************************************************************
+//
+// Number of reads that the server answered with 304 Not Modified.
+//
+//*****************************************************************************
+uint32_t g_ui32ReadsNotModified;
+
+//*****************************************************************************
+//
+// Snapshot of the values written to the server with a POST request.  The
+// request body is generated from this twice, once to size it and once to send
+// it, so both passes must see the same values.  The other tasks can change
+// the aliases in between, so every value written, including the strings, is
+// copied here by GetRequestBody().  REQUEST_STRINGS_SIZE adds up the storage
+// of all aliases, which is enough room for all string values.
+//
+//*****************************************************************************
+#define ALIAS(id, name, type, read, storage, rw, flags, bit)                 \
+    + sizeof(storage)
+enum
+{
+    REQUEST_STRINGS_SIZE = 0 ALIAS_TABLE
+};
+#undef ALIAS
+
+typedef struct
+{
+    //
+    // Values of the numeric aliases, by index in g_psAliases.
+    //
+    uint32_t pui32Values[NUM_ALIASES];
+
+    //
+    // Values of the string aliases, each 0 terminated, and the offset of
+    // each one in pcStrings by index in g_psAliases.
+    //
+    uint16_t pui16Strings[NUM_ALIASES];
+    char pcStrings[REQUEST_STRINGS_SIZE];
+
+    //
+    // Bit mask of the aliases in g_psAliases that are written, by index.
+    // This is 0 if none of them changed since they were last written.
+    //
+    uint32_t ui32Dirty;
+} tRequestBody;
+
+//*****************************************************************************
+//
+// Global resources to hold the values of the numeric aliases as last written
+// to the server and the clock ticks when all aliases were last written.
+// g_bFullRefresh forces all aliases to be written with the next request.
+//
+//*****************************************************************************
+static uint32_t g_pui32LastSent[NUM_ALIASES];
+static uint32_t g_ui32RefreshTicks;
+static bool g_bFullRefresh = true;
+
+//*****************************************************************************
+//
+// Global resource to count the sync cycles where no alias had changed, so no
+// write was made.
+//
+//*****************************************************************************
+uint32_t g_ui32WritesSkipped;
+
+//*****************************************************************************
+//
+// Global resources to hold the long-poll task, created the first time the
+// Sync_LongPoll mode is used, and the keep-alive state of its connection.
+//
+//*****************************************************************************
+static Task_Handle g_psLongPollHandle = NULL;
+static tKeepAlive g_sLongPollKeepAlive;
+
+//*****************************************************************************
+//
+// Message that the long-poll task posts to LongPollMailbox for each alias
+// value it reads.  The Cloud task applies the values, so the long-poll task
+// never writes the board data.  The size of this must match the message
+// size of LongPollMailbox in secure_iot.cfg.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32Alias;
+    char pcValue[FORM_VALUE_SIZE];
+} tAliasValueMsg;
+
+//*****************************************************************************
+//
+// Global resources used only by the long-poll task: the message being posted,
+// the number of values posted from the current response and the TLS session
+// of its own connection.  The long-poll task resumes its
+// own session rather than the Cloud task's, which the Cloud task may free at
+// any time.
+//
+//*****************************************************************************
+static tAliasValueMsg g_sLongPollMsg;
+static uint32_t g_ui32LongPollValues;
+static WOLFSSL_SESSION *g_psLongPollTLSSession = NULL;
+
+//*****************************************************************************
+//
+// Global resource to hold the long-poll read counters.
+//
+//*****************************************************************************
+tLongPollStats g_sLongPollStats;
+
+//*****************************************************************************
+//
+// Global resource to hold the TLS session of the last successful handshake.
+// It points into WolfSSL's client session cache and is offered to the server
+// on the next connect so that reconnects use an abbreviated handshake.
+//
+//*****************************************************************************
+static WOLFSSL_SESSION *g_psTLSSession = NULL;
+
+#ifdef PERSIST_TLS_SESSION
+//*****************************************************************************
+//
+// Global resources to hold the TLS session restored from EEPROM, which unlike
+// the sessions in WolfSSL's cache is owned by this module, and a word aligned
+// buffer for serializing sessions to and from EEPROM.
+//
+//*****************************************************************************
+static WOLFSSL_SESSION *g_psSavedTLSSession = NULL;
+static uint32_t g_pui32TLSSessionBuf[TLS_SESSION_MAX_LENGTH / 4];
+
+//*****************************************************************************
+//
+// Global resource to hold the hash of the session that is in EEPROM, so that
+// the same session is not written again.
+//
+//*****************************************************************************
+static uint32_t g_ui32SavedTLSHash;
+
+//*****************************************************************************
+//
+// Returns the FNV-1a hash of a serialized TLS session.
+//
+//*****************************************************************************
+static uint32_t
+TLSSessionHash(const uint8_t *pui8Buf, uint32_t ui32Len)
+{
+    uint32_t ui32Hash = 2166136261U;
+
+    while(ui32Len--)
+    {
+        ui32Hash = (ui32Hash ^ *pui8Buf++) * 16777619U;
+    }
+
+    return (ui32Hash);
 }
+#endif
 
 //*****************************************************************************
 //
-// Returns time since reset, in ui32PrevTicks.
+// Global resource to hold the TLS session resumption counters and handshake
+// timing.
 //
 //*****************************************************************************
-uint32_t
-ReadOnTime(void)
+tTLSStats g_sTLSStats;
+
+//*****************************************************************************
+//
+// Set the TLS session to be offered on the next connect.  A session restored
+// from EEPROM is freed once it is no longer needed.
+//
+//*****************************************************************************
+static void
+SetTLSSession(WOLFSSL_SESSION *psSession)
 {
-    static uint32_t ui32Seconds = 0;
-    static uint32_t ui32PrevTicks = 0;
-    uint32_t ui32Ticks = 0;
+#ifdef PERSIST_TLS_SESSION
+    if((g_psSavedTLSSession != NULL) && (g_psSavedTLSSession != psSession))
+    {
+        wolfSSL_SESSION_free(g_psSavedTLSSession);
+        g_psSavedTLSSession = NULL;
+    }
+#endif
 
-    ui32Ticks = Clock_getTicks();
+    g_psTLSSession = psSession;
+}
+
+//*****************************************************************************
+//
+// Save a TLS session along with its expiry to EEPROM.  This is done after
+// every handshake, but the EEPROM is only written if the session differs from
+// the one already in it, so resuming an unchanged session costs no write.
+//
+//*****************************************************************************
+static void
+SaveTLSSession(WOLFSSL_SESSION *psSession)
+{
+#ifdef PERSIST_TLS_SESSION
+    int32_t i32Len;
+    uint32_t ui32Hash;
+    uint8_t *pui8Buf;
 
     //
-    // Calculate seconds since reset by accounting for roolover of ticks.
+    // Make sure that the serialized session fits in the space reserved for it
+    // in EEPROM.
     //
-    if(ui32Ticks > ui32PrevTicks)
+    i32Len = wolfSSL_i2d_SSL_SESSION(psSession, NULL);
+    if((i32Len <= 0) || (i32Len > TLS_SESSION_MAX_LENGTH))
     {
-        ui32Seconds += ((ui32Ticks - ui32PrevTicks) / BIOS_TICK_RATE);
+        return;
     }
-    else
+
+    pui8Buf = (uint8_t *)g_pui32TLSSessionBuf;
+    i32Len = wolfSSL_i2d_SSL_SESSION(psSession, &pui8Buf);
+    if(i32Len <= 0)
     {
-        ui32Seconds += ((((uint32_t)(0xFFFFFFFF)) - ui32PrevTicks +
-                         ui32Ticks) / BIOS_TICK_RATE);
+        return;
     }
-    ui32PrevTicks = ui32Ticks;
 
-    return (ui32Seconds);
+    ui32Hash = TLSSessionHash((uint8_t *)g_pui32TLSSessionBuf,
+                              (uint32_t)i32Len);
+    if(ui32Hash == g_ui32SavedTLSHash)
+    {
+        return;
+    }
+    g_ui32SavedTLSHash = ui32Hash;
+
+    SaveTLSSessionEEPROM((uint8_t *)g_pui32TLSSessionBuf, (uint32_t)i32Len,
+                         (uint32_t)time(NULL) + TLS_SESSION_LIFETIME);
+#endif
 }
 
 //*****************************************************************************
 //
-// Builds the Request Body for the POST request.
+// This function restores the TLS session saved in EEPROM, if it has not yet
+// expired, so that it is offered on the first connect after a reboot.  System
+// time must be synchronized before this is called.
 //
 //*****************************************************************************
-void
-GetRequestBody(char* pcDataBuf, uint32_t ui32DataBufLen)
+static void
+LoadTLSSession(void)
 {
-    uint16_t ui16Temp = 0;
-    uint32_t pui32Buttons[2] = {0, 0};
-    uint32_t ui32DataLen = 0;
-    uint32_t ui32OnTime = 0;
+#ifdef PERSIST_TLS_SESSION
+    uint32_t ui32Len;
+    uint32_t ui32Expiry;
+    const uint8_t *pui8Buf;
 
-    ui16Temp = ReadInternalTemp();
-    ReadButtons(pui32Buttons);
-    ui32OnTime = ReadOnTime();
-    ui32DataLen = snprintf(pcDataBuf, ui32DataBufLen, "usrsw1=%d&usrsw2=%d",
-                           pui32Buttons[0], pui32Buttons[1]);
-    ui32DataLen += snprintf((pcDataBuf + ui32DataLen),
-                            (ui32DataBufLen - ui32DataLen), "&jtemp=%u",
-                            ui16Temp);
-    ui32DataLen += snprintf((pcDataBuf + ui32DataLen),
-                            (ui32DataBufLen - ui32DataLen), "&ontime=%d",
-                            ui32OnTime);
-    if((g_eBoardStaeRW == READ_WRITE) || (g_eBoardStaeRW == WRITE_ONLY))
+    if(GetTLSSessionEEPROM((uint8_t *)g_pui32TLSSessionBuf, &ui32Len,
+                           &ui32Expiry) != true)
+    {
+        return;
+    }
+
+    //
+    // Don't bother offering a session that the server has already discarded.
+    //
+    if((uint32_t)time(NULL) >= ui32Expiry)
     {
-        ui32DataLen += snprintf((pcDataBuf + ui32DataLen),
-                                (ui32DataBufLen - ui32DataLen), "&gamestate="
-                                "0x%x", g_ui32BoardState);
+        return;
     }
-    if((g_eLEDD1RW == READ_WRITE) || (g_eLEDD1RW == WRITE_ONLY))
+
+    g_ui32SavedTLSHash = TLSSessionHash((uint8_t *)g_pui32TLSSessionBuf,
+                                        ui32Len);
+
+    pui8Buf = (const uint8_t *)g_pui32TLSSessionBuf;
+    g_psSavedTLSSession = wolfSSL_d2i_SSL_SESSION(NULL, &pui8Buf,
+                                                  (long)ui32Len);
+    if(g_psSavedTLSSession != NULL)
     {
-        ui32DataLen += snprintf((pcDataBuf + ui32DataLen),
-                                (ui32DataBufLen - ui32DataLen), "&ledd1=%d",
-                                g_ui32LEDD1);
+        g_psTLSSession = g_psSavedTLSSession;
+
+        g_sDebug.ui32Request = Cmd_Prompt_Print;
+        snprintf(g_sDebug.pcBuf, TX_BUF_SIZE, "TLS session found in EEPROM."
+                 "\n");
+        Mailbox_post(CloudMailbox, &g_sDebug, BIOS_NO_WAIT);
+        System_printf(g_sDebug.pcBuf);
     }
-    if((g_eEmailRW == READ_WRITE) || (g_eEmailRW == WRITE_ONLY))
+#endif
+}
+
+//*****************************************************************************
+//
+// This function completes the TLS handshake on a freshly connected HTTP client
+// instance.  The WolfSSL secure socket layer only creates the SSL object when
+// HTTPCli_connect() is called and the handshake is run on the first write, so
+// the cached session can still be offered to the server at this point.  The
+// time taken, from ui32StartTicks, is recorded along with whether the server
+// resumed the session.
+//
+//*****************************************************************************
+static int32_t
+TLSHandshake(HTTPCli_Handle cli, uint32_t ui32StartTicks)
+{
+    WOLFSSL *psSSL;
+    uint32_t ui32Ms;
+
+    psSSL = (WOLFSSL *)cli->ssock.ssl;
+    if(psSSL == NULL)
     {
-        ui32DataLen += snprintf((pcDataBuf + ui32DataLen),
-                                (ui32DataBufLen - ui32DataLen),
-                                "&emailaddr=%s", g_pcEmail);
+        return (-1);
     }
-    if((g_eAlertRW == READ_WRITE) || (g_eAlertRW == WRITE_ONLY))
+
+    //
+    // Offer the session from the previous connection, if any.
+    //
+    if(g_psTLSSession != NULL)
     {
-        ui32DataLen += snprintf((pcDataBuf + ui32DataLen),
-                                (ui32DataBufLen - ui32DataLen),
-                                "&alert=%s", g_pcAlert);
+        wolfSSL_set_session(psSSL, g_psTLSSession);
     }
-    if(g_eLEDD1RW == READ_WRITE)
+
+    //
+    // Run the handshake now instead of on the first request.
+    //
+    if(wolfSSL_connect(psSSL) != SSL_SUCCESS)
     {
-        g_eLEDD1RW = READ_ONLY;
+        //
+        // Don't offer this session again.  The next attempt will perform a
+        // full handshake.
+        //
+        SetTLSSession(NULL);
+        return (-1);
     }
-    if(g_eBoardStaeRW == READ_WRITE)
+
+    //
+    // Update the counters.  Clock ticks are in milliseconds.
+    //
+    ui32Ms = (Clock_getTicks() - ui32StartTicks) * 1000 / BIOS_TICK_RATE;
+    g_sTLSStats.ui32LastMs = ui32Ms;
+    if(wolfSSL_session_reused(psSSL))
     {
-        g_eBoardStaeRW = READ_ONLY;
+        g_sTLSStats.ui32Hits++;
+        g_sTLSStats.ui32ResumedMs += ui32Ms;
     }
-    if(g_eEmailRW == READ_WRITE)
+    else
     {
-        g_eEmailRW = READ_ONLY;
+        g_sTLSStats.ui32Misses++;
+        g_sTLSStats.ui32FullMs += ui32Ms;
     }
-    if(g_eAlertRW == READ_WRITE)
+
+    //
+    // Remember this session for the next connect, and save it to EEPROM to
+    // be used after a reboot.  A resumed session may carry a new ticket, so
+    // it is saved too; SaveTLSSession() skips the write if nothing changed.
+    //
+    SetTLSSession(wolfSSL_get_session(psSSL));
+    if(g_psTLSSession != NULL)
     {
-        g_eAlertRW = NONE;
+        SaveTLSSession(g_psTLSSession);
+    }
+
+    return (0);
+}
+
+//*****************************************************************************
+//
+// Reset the keep-alive state for a new connection.
+//
+//*****************************************************************************
+static void
+KeepAliveReset(tKeepAlive *psKeepAlive)
+{
+    psKeepAlive->bClose = false;
+    psKeepAlive->ui32Remaining = KEEPALIVE_UNLIMITED;
+    psKeepAlive->ui32Timeout = 0;
+    psKeepAlive->ui32RetryAfter = 0;
+    psKeepAlive->ui32LastTicks = Clock_getTicks();
+}
+
+//*****************************************************************************
+//
+// Check if the server will close the connection described by psKeepAlive
+// before ui32Requests more requests can be made on it.
+//
+//*****************************************************************************
+static bool
+KeepAliveExpiring(tKeepAlive *psKeepAlive, uint32_t ui32Requests)
+{
+    uint32_t ui32IdleMs;
+
+    if(psKeepAlive->bClose)
+    {
+        return true;
+    }
+
+    if((psKeepAlive->ui32Remaining != KEEPALIVE_UNLIMITED) &&
+       (psKeepAlive->ui32Remaining < ui32Requests))
+    {
+        return true;
+    }
+
+    if(psKeepAlive->ui32Timeout != 0)
+    {
+        ui32IdleMs = ((Clock_getTicks() - psKeepAlive->ui32LastTicks) * 1000 /
+                      BIOS_TICK_RATE);
+        if((ui32IdleMs + KEEPALIVE_MARGIN_MS) >=
+           (psKeepAlive->ui32Timeout * 1000))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//*****************************************************************************
+//
+// Read the response headers.  Only the fields in g_ppcResponseFields are
+// returned by HTTPCli, which are used to track how long the server will keep
+// the connection open, and the delay it asked for before the next request, in
+// psKeepAlive.  If psValidator is not NULL, the ETag and Last-Modified
+// validators are stored in it.  Returns 0 or a negative HTTPCli error.
+//
+//*****************************************************************************
+static int32_t
+ReadResponseFields(HTTPCli_Handle cli, tKeepAlive *psKeepAlive,
+                   tReadValidator *psValidator, char *pcBuf,
+                   uint32_t ui32BufLen)
+{
+    int32_t i32Ret;
+    bool bMoreFlag;
+    char *pcValue;
+    char *pcChar;
+
+    //
+    // This response used up one request of the connection.
+    //
+    psKeepAlive->ui32LastTicks = Clock_getTicks();
+    psKeepAlive->ui32RetryAfter = 0;
+    if((psKeepAlive->ui32Remaining != KEEPALIVE_UNLIMITED) &&
+       (psKeepAlive->ui32Remaining != 0))
+    {
+        psKeepAlive->ui32Remaining--;
+    }
+
+    while(1)
+    {
+        i32Ret = HTTPCli_getResponseField(cli, pcBuf, ui32BufLen, &bMoreFlag);
+        if((i32Ret == HTTPCli_FIELD_ID_END) ||
+           (i32Ret == HTTPCli_FIELD_ID_DUMMY))
+        {
+            return (0);
+        }
+        else if(i32Ret < 0)
+        {
+            return (i32Ret);
+        }
+
+        pcBuf[ui32BufLen - 1] = '\0';
+
+        if((i32Ret == RESPONSE_FIELD_ETAG) ||
+           (i32Ret == RESPONSE_FIELD_LAST_MODIFIED))
+        {
+            //
+            // Validators are opaque and must be sent back exactly as they
+            // were received.  One that didn't fit is not used.
+            //
+            if(psValidator != NULL)
+            {
+                pcValue = ((i32Ret == RESPONSE_FIELD_ETAG) ?
+                           psValidator->pcETag :
+                           psValidator->pcLastModified);
+                if(bMoreFlag || (strlen(pcBuf) >= VALIDATOR_SIZE))
+                {
+                    pcValue[0] = '\0';
+                }
+                else
+                {
+                    strcpy(pcValue, pcBuf);
+                }
+            }
+            continue;
+        }
+
+        //
+        // The connection management header values are case insensitive.
+        //
+        for(pcChar = pcBuf; *pcChar; pcChar++)
+        {
+            *pcChar = tolower(*pcChar);
+        }
+
+        if(i32Ret == RESPONSE_FIELD_CONNECTION)
+        {
+            //
+            // Connection: close | keep-alive
+            //
+            psKeepAlive->bClose = (strstr(pcBuf, "close") != NULL);
+        }
+        else if(i32Ret == RESPONSE_FIELD_RETRY_AFTER)
+        {
+            //
+            // Retry-After: <secs>.  The HTTP-date form is not used for 429
+            // and 503 responses in practice, and is left to the backoff.
+            //
+            psKeepAlive->ui32RetryAfter = strtoul(pcBuf, NULL, 10);
+            if(psKeepAlive->ui32RetryAfter > RETRY_AFTER_MAX)
+            {
+                psKeepAlive->ui32RetryAfter = RETRY_AFTER_MAX;
+            }
+        }
+        else if(i32Ret == RESPONSE_FIELD_KEEP_ALIVE)
+        {
+            //
+            // Keep-Alive: timeout=<secs>, max=<requests left>
+            //
+            pcValue = strstr(pcBuf, "timeout=");
+            if(pcValue != NULL)
+            {
+                psKeepAlive->ui32Timeout = strtoul(pcValue + 8, NULL, 10);
+            }
+            pcValue = strstr(pcBuf, "max=");
+            if(pcValue != NULL)
+            {
+                psKeepAlive->ui32Remaining = strtoul(pcValue + 4, NULL, 10);
+            }
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Sets the HTTP proxy for the next HTTPCli_connect() from the endpoint it is
+// made through.  The proxy is a setting of the HTTP client library, not of
+// an instance, so it must be cleared before each connect that doesn't go
+// through a proxy.  A zeroed address clears it, as it is the library's
+// initial setting.
+//
+//*****************************************************************************
+static void
+ProxySet(const tEndpoint *psEndpoint, struct sockaddr_in *psSockAddr)
+{
+    struct sockaddr_in sNoProxy;
+
+    if(psEndpoint->bProxy == true)
+    {
+        HTTPCli_setProxy((struct sockaddr *)psSockAddr);
+    }
+    else
+    {
+        memset(&sNoProxy, 0, sizeof(sNoProxy));
+        HTTPCli_setProxy((struct sockaddr *)&sNoProxy);
+    }
+}
+
+//*****************************************************************************
+//
+// This function creates a HTTP client instance and connects to the Exosite
+// Server through the given endpoint.  Returns 0 or a negative HTTPCli error.
+//
+//*****************************************************************************
+static int32_t
+ServerConnectTo(HTTPCli_Handle cli, tEndpoint *psEndpoint)
+{
+    int32_t i32Ret = 0;
+    struct sockaddr_in sSockAddr;
+    uint32_t ui32StartTicks;
+    char * pcDebug;
+
+    g_sDebug.ui32Request = Cmd_Prompt_Print;
+    pcDebug = g_sDebug.pcBuf;
+
+    //
+    // Find the address of the host that answers first.  A host with several
+    // addresses is reached even if some of them don't answer, without
+    // waiting for a TCP timeout.
+    //
+    LatencyStart(&g_sLatencyTimer);
+    i32Ret = ConnectRace(psEndpoint->pcAddr, psEndpoint->ui32LastAddr,
+                         &sSockAddr, &g_sLatencyTimer);
+    if(i32Ret != 0)
+    {
+        //
+        // Failed to resolve or reach the host.  Report error and return.
+        //
+        snprintf(pcDebug, TX_BUF_SIZE, "Failed to reach %s. Check proxy "
+                 "server settings.\n", psEndpoint->pcAddr);
+        Mailbox_post(CloudMailbox, &g_sDebug, BIOS_NO_WAIT);
+        System_printf(pcDebug);
+        return (i32Ret);
+    }
+    psEndpoint->ui32LastAddr = sSockAddr.sin_addr.s_addr;
+
+    //
+    // Set the proxy if the endpoint is one, or clear the one set by an
+    // earlier connect.
+    //
+    ProxySet(psEndpoint, &sSockAddr);
+
+    g_sDebug.ui32Request = Cmd_Prompt_No_Print;
+    snprintf(pcDebug, TX_BUF_SIZE, "Connecting to server (%s)...",
+             psEndpoint->pcName);
+    Mailbox_post(CloudMailbox, &g_sDebug, 100);
+    System_printf(pcDebug);
+    System_printf("\n");
+    g_sDebug.ui32Request = Cmd_Prompt_Print;
+
+    //
+    // Create an HTTP client instance.
+    //
+    HTTPCli_construct(cli);
+
+    //
+    // Set-up headers that are to be sent automatically with GET/POST request,
+    // and the response headers that we want to see.
+    //
+    HTTPCli_setRequestFields(cli, g_psFields);
+    HTTPCli_setResponseFields(cli, g_ppcResponseFields);
+
+    //
+    // Connect a socket to Exosite server in secure mode and complete the TLS
+    // handshake, resuming the previous session if possible.
+    //
+    ui32StartTicks = Clock_getTicks();
+    i32Ret = HTTPCli_connect(cli, (struct sockaddr *)&sSockAddr,
+                             HTTPCli_TYPE_TLS, NULL);
+    if(i32Ret == 0)
+    {
+        i32Ret = TLSHandshake(cli, ui32StartTicks);
+        if(i32Ret != 0)
+        {
+            HTTPCli_disconnect(cli);
+        }
+    }
+    LatencyMark(&g_sLatencyTimer, LATENCY_TLS);
+    if(i32Ret != 0)
+    {
+        //
+        // Failed to connect.  Deconstruct the HTTP client instance and
+        // return with error.
+        //
+        HTTPCli_destruct(cli);
+
+        snprintf(pcDebug, TX_BUF_SIZE, "Failed to connect to server, ecode: "
+                 "%d.\n", i32Ret);
+        Mailbox_post(CloudMailbox, &g_sDebug, BIOS_NO_WAIT);
+        System_printf(pcDebug);
+        return (i32Ret);
+    }
+
+    return (0);
+}
+
+//*****************************************************************************
+//
+// This function connects to the Exosite Server through the healthy endpoint
+// with the best score.  If that fails, the connect moves on to the next best
+// healthy endpoint, and so on.  The endpoints that keep failing are demoted,
+// so they are only tried again once their hold time is over or when no other
+// endpoint is left.  The Cloud task schedules the next attempt with the
+// connect retry policy if all of them failed.
+//
+//*****************************************************************************
+int32_t
+ServerConnect(HTTPCli_Handle cli)
+{
+    tEndpoint *psEndpoint;
+    uint32_t ui32Tried;
+    int32_t i32Idx;
+    char * pcDebug;
+
+    g_sDebug.ui32Request = Cmd_Prompt_Print;
+    pcDebug = g_sDebug.pcBuf;
+
+    ui32Tried = 0;
+    while(1)
+    {
+        i32Idx = EndpointSelect(g_psEndpoints, NUM_ENDPOINTS, ui32Tried,
+                                Clock_getTicks());
+        if(i32Idx < 0)
+        {
+            return (-1);
+        }
+        ui32Tried |= (1 << i32Idx);
+        psEndpoint = &g_psEndpoints[i32Idx];
+
+        if(ServerConnectTo(cli, psEndpoint) == 0)
+        {
+            break;
+        }
+
+        EndpointFailure(psEndpoint, Clock_getTicks(),
+                        (ENDPOINT_HOLD_MS * BIOS_TICK_RATE) / 1000);
+    }
+
+    //
+    // Success.  The endpoint is scored on the time from the start of
+    // HTTPCli_connect() to the end of the handshake, which covers the same
+    // TCP connect and handshake for every endpoint.
+    //
+    EndpointSuccess(psEndpoint, g_sTLSStats.ui32LastMs);
+    g_ui32Endpoint = i32Idx;
+    KeepAliveReset(&g_sKeepAlive);
+    snprintf(pcDebug, TX_BUF_SIZE, "Connected to Exosite server (%s, %s "
+             "handshake, %d ms).\n", psEndpoint->pcName,
+             (wolfSSL_session_reused((WOLFSSL *)cli->ssock.ssl) ? "resumed" :
+              "full"), g_sTLSStats.ui32LastMs);
+    Mailbox_post(CloudMailbox, &g_sDebug, 100);
+    System_printf(pcDebug);
+    return (0);
+}
+
+//*****************************************************************************
+//
+// Disconnect from the Exosite Server and destroy the HTTP client instance.
+//
+//*****************************************************************************
+void
+ServerDisconnect(HTTPCli_Handle cli)
+{
+    HTTPCli_disconnect(cli);
+}
+
+//*****************************************************************************
+//
+// Disconnect and Connect back to the Exosite Server.
+//
+//*****************************************************************************
+int32_t
+ServerReconnect(HTTPCli_Handle cli)
+{
+    ServerDisconnect(cli);
+    return (ServerConnect(cli));
+}
+
+//*****************************************************************************
+//
+// This function tries to read a CIK from non-volatile memory and reports if
+// one if found or not.  If a CIK is present in NVM then it is copied to global
+// resource.
+//
+//*****************************************************************************
+bool
+GetCIK(HTTPCli_Handle cli)
+{
+    char pcCIK[EXOSITE_CIK_LENGTH + 1];
+    char * pcDebug;
+    UInt uKey;
+
+    g_sDebug.ui32Request = Cmd_Prompt_Print;
+    pcDebug = g_sDebug.pcBuf;
+
+    if(GetCIKEEPROM(pcCIK) == true)
+    {
+        if(pcCIK != NULL)
+        {
+            //
+            // CIK Found.  Update the global resource with CIK found in NVM.
+            // The long-poll task copies it with task switching disabled, so
+            // it is updated the same way.
+            //
+            uKey = Task_disable();
+            memcpy(g_pcExositeCIK, pcCIK, EXOSITE_CIK_LENGTH + 1);
+            Task_restore(uKey);
+
+            //
+            // Report this to user.
+            //
+            snprintf(pcDebug, TX_BUF_SIZE, "CIK found in EEPROM %s\n",
+                     g_pcExositeCIK);
+            Mailbox_post(CloudMailbox, &g_sDebug, BIOS_NO_WAIT);
+            System_printf(pcDebug);
+
+            //
+            // Return success.
+            //
+            return true;
+        }
+    }
+
+    //
+    // CIK not found. Report this.
+    //
+    snprintf(pcDebug, TX_BUF_SIZE, "No CIK found in EEPROM.\n");
+    Mailbox_post(CloudMailbox, &g_sDebug, BIOS_NO_WAIT);
+    System_printf(pcDebug);
+
+    //
+    // Return failure.
+    //
+    return false;
+}
+
+//*****************************************************************************
+//
+// Set the proxy value if requested by the user.
+//
+//*****************************************************************************
+void
+CloudProxySet(HTTPCli_Handle cli, char *pcProxy)
+{
+    char * pcPort;
+
+    //
+    // Check if the buffer has proxy address.
+    //
+    if(pcProxy == NULL)
+    {
+        //
+        // No - Return without doing anything.
+        //
+        g_ui32State = Cloud_Idle;
+        return;
+    }
+
+    //
+    // Check if a port number was passed.
+    //
+    pcPort = strstr(pcProxy, ":");
+    if(pcPort == NULL)
+    {
+        //
+        // No - Return without doing anything.
+        //
+        g_ui32State = Cloud_Idle;
+        return;
+    }
+
+    //
+    // Copy the proxy address to the proxy endpoint.  From now on it is scored
+    // along with the other endpoints, and used when they fail or are slower.
+    //
+    EndpointSet(&g_psEndpoints[ENDPOINT_PROXY], pcProxy);
+
+    //
+    // The cached TLS session belongs to the old route.  Start over with a
+    // full handshake.
+    //
+    SetTLSSession(NULL);
+
+    return;
+}
+
+//*****************************************************************************
+//
+// Appends a "<name>: <value>" header, terminated by CRLF, to a format
+// cursor.  FormatNumberField() does the same for a numeric value.  Returns
+// false if the header did not fit.
+//
+//*****************************************************************************
+static bool
+FormatField(tFormatCursor *psCursor, const char *pcName, const char *pcValue)
+{
+    FormatString(psCursor, pcName);
+    FormatBytes(psCursor, ": ", 2);
+    FormatString(psCursor, pcValue);
+
+    return (FormatBytes(psCursor, "\r\n", 2));
+}
+
+static bool
+FormatNumberField(tFormatCursor *psCursor, const char *pcName,
+                  uint32_t ui32Value)
+{
+    FormatString(psCursor, pcName);
+    FormatBytes(psCursor, ": ", 2);
+    FormatDecimal(psCursor, ui32Value);
+
+    return (FormatBytes(psCursor, "\r\n", 2));
+}
+
+//*****************************************************************************
+//
+// Populate the request body for a POST request to get the CIK.  The request
+// body will have the provisioning information that Exosite server seeks.
+//
+//*****************************************************************************
+int32_t
+BuildProvInfo(const char *pcVendorName, const char *pcBoard,
+              char *pui8MACAddress, char *pcProvBuf, uint32_t ui32ProvBufLen)
+{
+    tFormatCursor sCursor;
+
+    //
+    // Build the request body for provisioning.
+    //
+    FormatInit(&sCursor, pcProvBuf, ui32ProvBufLen);
+    FormatString(&sCursor, g_ppcProvAlias[0]);
+    FormatBytes(&sCursor, "=", 1);
+    FormatURLEncoded(&sCursor, pcVendorName);
+    FormatBytes(&sCursor, "&", 1);
+    FormatString(&sCursor, g_ppcProvAlias[1]);
+    FormatBytes(&sCursor, "=", 1);
+    FormatURLEncoded(&sCursor, pcBoard);
+    FormatBytes(&sCursor, "&", 1);
+    FormatString(&sCursor, g_ppcProvAlias[2]);
+    FormatBytes(&sCursor, "=", 1);
+    FormatURLEncoded(&sCursor, pui8MACAddress);
+
+    //
+    // Fail if the request body did not fit in the buffer.
+    //
+    if(sCursor.bTruncated)
+    {
+        return -1;
+    }
+
+    //
+    // Indicate Success.
+    //
+    return 0;
+}
+
+//*****************************************************************************
+//
+// Returns time since reset, in ui32PrevTicks.
+//
+//*****************************************************************************
+uint32_t
+ReadOnTime(void)
+{
+    static uint32_t ui32Seconds = 0;
+    static uint32_t ui32PrevTicks = 0;
+    uint32_t ui32Ticks = 0;
+
+    ui32Ticks = Clock_getTicks();
+
+    //
+    // Calculate seconds since reset by accounting for roolover of ticks.
+    //
+    if(ui32Ticks > ui32PrevTicks)
+    {
+        ui32Seconds += ((ui32Ticks - ui32PrevTicks) / BIOS_TICK_RATE);
+    }
+    else
+    {
+        ui32Seconds += ((((uint32_t)(0xFFFFFFFF)) - ui32PrevTicks +
+                         ui32Ticks) / BIOS_TICK_RATE);
+    }
+    ui32PrevTicks = ui32Ticks;
+
+    return (ui32Seconds);
+}
+
+//*****************************************************************************
+//
+// Functions that read the value of the sensor aliases.
+//
+//*****************************************************************************
+static uint32_t
+ReadSwitch1(void)
+{
+    uint32_t pui32Buttons[2];
+
+    ReadButtons(pui32Buttons);
+
+    return (pui32Buttons[0]);
+}
+
+static uint32_t
+ReadSwitch2(void)
+{
+    uint32_t pui32Buttons[2];
+
+    ReadButtons(pui32Buttons);
+
+    return (pui32Buttons[1]);
+}
+
+static uint32_t
+ReadTemp(void)
+{
+    return (ReadInternalTemp());
+}
+
+//*****************************************************************************
+//
+// Checks the <sync bit> of an alias.  Returns -1 if it is not a bit of
+// g_ui32SyncMask.
+//
+//*****************************************************************************
+#define ALIAS(id, name, type, read, storage, rw, flags, bit)                 \
+    case bit:
+static int32_t
+AliasSyncBitCheck(uint32_t ui32Idx)
+{
+    //
+    // There is one case per sync bit, so two aliases that share a bit fail
+    // the build with a duplicate case value.
+    //
+    switch(g_psAliases[ui32Idx].ui32SyncBit)
+    {
+        ALIAS_TABLE
+        {
+            break;
+        }
+
+        default:
+        {
+            return (-1);
+        }
+    }
+
+    return ((g_psAliases[ui32Idx].ui32SyncBit < 32) ? 0 : -1);
+}
+#undef ALIAS
+
+//*****************************************************************************
+//
+// Fills the hash table used to find the aliases by name and checks their sync
+// bits.  Returns -1 if two aliases share a slot of the hash table or if
+// AliasSyncBitCheck() fails.
+//
+//*****************************************************************************
+static int32_t
+AliasTableInit(void)
+{
+    uint32_t ui32Idx, ui32Len, ui32Slot;
+    const char *pcName;
+
+    for(ui32Idx = 0; ui32Idx < NUM_ALIASES; ui32Idx++)
+    {
+        if(AliasSyncBitCheck(ui32Idx) != 0)
+        {
+            return (-1);
+        }
+
+        pcName = g_psAliases[ui32Idx].pcName;
+        ui32Len = strlen(pcName);
+        ui32Slot = ALIAS_HASH(ui32Len, pcName[0], pcName[ui32Len - 1]);
+        if(g_pui8AliasHash[ui32Slot] != 0)
+        {
+            return (-1);
+        }
+
+        g_pui8AliasHash[ui32Slot] = ui32Idx + 1;
+    }
+
+    return (0);
+}
+
+//*****************************************************************************
+//
+// Finds an alias by name.  Returns its index in g_psAliases or -1 if there is
+// no such alias.
+//
+//*****************************************************************************
+static int32_t
+AliasFind(const char *pcName)
+{
+    uint32_t ui32Len, ui32Idx;
+
+    ui32Len = strlen(pcName);
+    if(ui32Len == 0)
+    {
+        return (-1);
+    }
+
+    ui32Idx = g_pui8AliasHash[ALIAS_HASH(ui32Len, pcName[0],
+                                         pcName[ui32Len - 1])];
+    if((ui32Idx == 0) ||
+       (strcmp(g_psAliases[ui32Idx - 1].pcName, pcName) != 0))
+    {
+        return (-1);
+    }
+
+    return (ui32Idx - 1);
+}
+
+//*****************************************************************************
+//
+// Takes a snapshot of the values to be written with the POST request and
+// updates the Write/Read status of the aliases that are written.  Only the
+// aliases that changed since they were last written are marked to be
+// written, unless a full refresh is due.
+//
+//*****************************************************************************
+void
+GetRequestBody(tRequestBody *psBody)
+{
+    const tAlias *psAlias;
+    uint32_t ui32Enabled, ui32Ticks, ui32Idx, ui32Strings, ui32Len;
+    const char *pcEnd;
+    bool bFull;
+
+    ui32Ticks = Clock_getTicks();
+    bFull = (g_bFullRefresh ||
+             ((ui32Ticks - g_ui32RefreshTicks) >=
+              (FULL_REFRESH_PERIOD * BIOS_TICK_RATE)));
+    if(bFull)
+    {
+        g_bFullRefresh = false;
+        g_ui32RefreshTicks = ui32Ticks;
+    }
+
+    ui32Enabled = 0;
+    ui32Strings = 0;
+    psBody->ui32Dirty = 0;
+    for(ui32Idx = 0; ui32Idx < NUM_ALIASES; ui32Idx++)
+    {
+        psAlias = &g_psAliases[ui32Idx];
+
+        //
+        // Skip the aliases that the board does not write, or that the server
+        // disabled with the sync mask.  The sensor readings are not written
+        // when they are uploaded in batches by ExositeRecord() instead.
+        //
+        if(((*psAlias->peRW != READ_WRITE) &&
+            (*psAlias->peRW != WRITE_ONLY)) ||
+           ((*psAlias->peRW == WRITE_ONLY) &&
+            !(g_ui32SyncMask & (1U << psAlias->ui32SyncBit))) ||
+           ((psAlias->ui32Flags & ALIAS_SAMPLED) && (TelemetryBatch() != 0)))
+        {
+            continue;
+        }
+        ui32Enabled |= (1U << ui32Idx);
+
+        if(psAlias->pfnRead != NULL)
+        {
+            psBody->pui32Values[ui32Idx] = psAlias->pfnRead();
+        }
+        else if(psAlias->eType != Alias_String)
+        {
+            psBody->pui32Values[ui32Idx] = *(uint32_t *)psAlias->pvStorage;
+        }
+        else
+        {
+            pcEnd = memchr(psAlias->pvStorage, '\0', psAlias->ui32Size);
+            ui32Len = ((pcEnd != NULL) ? (pcEnd - (char *)psAlias->pvStorage) :
+                       (psAlias->ui32Size - 1));
+            psBody->pui16Strings[ui32Idx] = ui32Strings;
+            memcpy(psBody->pcStrings + ui32Strings, psAlias->pvStorage,
+                   ui32Len);
+            psBody->pcStrings[ui32Strings + ui32Len] = '\0';
+            ui32Strings += ui32Len + 1;
+        }
+
+        //
+        // Unless all of them are written, only write the values that
+        // changed, and the aliases that are READ_WRITE as those were just
+        // changed on the board.  Piggyback aliases are only written along
+        // with another alias.
+        //
+        if((*psAlias->peRW == READ_WRITE) ||
+           (!(psAlias->ui32Flags & ALIAS_PIGGYBACK) &&
+            (psAlias->eType != Alias_String) &&
+            (psBody->pui32Values[ui32Idx] != g_pui32LastSent[ui32Idx])))
+        {
+            psBody->ui32Dirty |= (1U << ui32Idx);
+        }
+
+        //
+        // Update the Write/Read status of the aliases that are written once.
+        //
+        if(*psAlias->peRW == READ_WRITE)
+        {
+            *psAlias->peRW = ((psAlias->ui32Flags & ALIAS_EVENT) ? NONE :
+                              READ_ONLY);
+        }
+    }
+
+    if(bFull || (psBody->ui32Dirty != 0))
+    {
+        for(ui32Idx = 0; ui32Idx < NUM_ALIASES; ui32Idx++)
+        {
+            if((ui32Enabled & (1U << ui32Idx)) &&
+               (bFull || (g_psAliases[ui32Idx].ui32Flags & ALIAS_PIGGYBACK)))
+            {
+                psBody->ui32Dirty |= (1U << ui32Idx);
+            }
+        }
+    }
+
+    for(ui32Idx = 0; ui32Idx < NUM_ALIASES; ui32Idx++)
+    {
+        if(psBody->ui32Dirty & (1U << ui32Idx))
+        {
+            g_pui32LastSent[ui32Idx] = psBody->pui32Values[ui32Idx];
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Emits one fragment of the request body.  If psSend is NULL, the fragment
+// is only counted.
+//
+//*****************************************************************************
+static int32_t
+EmitRequestBody(tSendBuffer *psSend, const char *pcBuf, uint32_t ui32Len,
+                uint32_t *pui32Total)
+{
+    *pui32Total += ui32Len;
+    if(psSend == NULL)
+    {
+        return (0);
+    }
+
+    return (SendBufferWrite(psSend, pcBuf, ui32Len));
+}
+
+//*****************************************************************************
+//
+// Emits a 0 terminated string as a URL encoded fragment of the request body.
+// The string is encoded in small pieces, so it can be of any length.  If
+// psSend is NULL, the encoded length is only counted.
+//
+//*****************************************************************************
+static int32_t
+EmitURLEncoded(tSendBuffer *psSend, const char *pcStr, uint32_t *pui32Total)
+{
+    char pcEncoded[48];
+    uint32_t ui32Len, ui32Chunk;
+    int32_t i32Ret;
+
+    ui32Len = strlen(pcStr);
+    if(psSend == NULL)
+    {
+        *pui32Total += URLEncodedLength(pcStr, ui32Len);
+        return (0);
+    }
+
+    while(ui32Len != 0)
+    {
+        //
+        // Each byte is at most 3 bytes once encoded.
+        //
+        ui32Chunk = (ui32Len < (sizeof(pcEncoded) / 3)) ? ui32Len :
+                    (sizeof(pcEncoded) / 3);
+        i32Ret = EmitRequestBody(psSend, pcEncoded,
+                                 URLEncode(pcEncoded, pcStr, ui32Chunk),
+                                 pui32Total);
+        if(i32Ret < 0)
+        {
+            return (i32Ret);
+        }
+
+        pcStr += ui32Chunk;
+        ui32Len -= ui32Chunk;
+    }
+
+    return (0);
+}
+
+//*****************************************************************************
+//
+// Writes the request body for the POST request to the send buffer, one field
+// at a time, so its size is not limited by a buffer.  If psSend is NULL,
+// nothing is sent and only the length of the body is computed.  Returns
+// the length of the body or a negative HTTPCli error.
+//
+// <alias 1>=<value 1>&<alias 2...>=<value 2...>&<alias n>=<value n>
+//
+//*****************************************************************************
+int32_t
+WriteRequestBody(tSendBuffer *psSend, tRequestBody *psBody)
+{
+    const tAlias *psAlias;
+    tFormatCursor sCursor;
+    char pcField[32];
+    uint32_t ui32Total = 0;
+    uint32_t ui32Idx;
+    int32_t i32Ret;
+
+    for(ui32Idx = 0; ui32Idx < NUM_ALIASES; ui32Idx++)
+    {
+        if(!(psBody->ui32Dirty & (1U << ui32Idx)))
+        {
+            continue;
+        }
+
+        psAlias = &g_psAliases[ui32Idx];
+        FormatInit(&sCursor, pcField, sizeof(pcField));
+        if(ui32Total)
+        {
+            FormatBytes(&sCursor, "&", 1);
+        }
+        FormatString(&sCursor, psAlias->pcName);
+        FormatBytes(&sCursor, "=", 1);
+        if(psAlias->eType == Alias_Hex)
+        {
+            FormatHex(&sCursor, psBody->pui32Values[ui32Idx]);
+        }
+        else if(psAlias->eType != Alias_String)
+        {
+            FormatDecimal(&sCursor, psBody->pui32Values[ui32Idx]);
+        }
+        i32Ret = EmitRequestBody(psSend, pcField, sCursor.ui32Len,
+                                 &ui32Total);
+
+        //
+        // The string values are URL encoded from the snapshot, so a '&',
+        // '=', '+' or space in them can't break the body.
+        //
+        if((i32Ret == 0) && (psAlias->eType == Alias_String))
+        {
+            i32Ret = EmitURLEncoded(psSend, (psBody->pcStrings +
+                                             psBody->pui16Strings[ui32Idx]),
+                                    &ui32Total);
+        }
+        if(i32Ret < 0)
+        {
+            return (i32Ret);
+        }
+    }
+
+    return (ui32Total);
+}
+
+//*****************************************************************************
+//
+// Writes the request body for the record call of ExositeRecord() to the send
+// buffer.  This holds the oldest ui32Count samples of each sensor with their
+// timestamps.  If psSend is NULL, nothing is sent and only the length of the
+// body is computed.  Returns the length of the body or a negative HTTPCli
+// error.
+//
+// {"auth":{"cik":"<CIK>"},"calls":[
+//  {"id":0,"procedure":"record","arguments":[{"alias":"jtemp"},
+//   [[<time 1>,<value 1>],...,[<time n>,<value n>]],{}]},...]}
+//
+//*****************************************************************************
+int32_t
+WriteRecordBody(tSendBuffer *psSend, uint32_t ui32Count)
+{
+    tFormatCursor sCursor;
+    char pcField[96];
+    uint32_t ui32Total = 0;
+    uint32_t ui32Alias, ui32Index, ui32Value;
+    tTelemetrySample sSample;
+    int32_t i32Ret;
+
+    i32Ret = snprintf(pcField, sizeof(pcField),
+                      "{\"auth\":{\"cik\":\"%s\"},\"calls\":[",
+                      g_pcExositeCIK);
+    i32Ret = EmitRequestBody(psSend, pcField, i32Ret, &ui32Total);
+    if(i32Ret < 0)
+    {
+        return (i32Ret);
+    }
+
+    for(ui32Alias = 0; ui32Alias < RECORD_ALIASES; ui32Alias++)
+    {
+        i32Ret = snprintf(pcField, sizeof(pcField), "%s{\"id\":%d,"
+                          "\"procedure\":\"record\",\"arguments\":"
+                          "[{\"alias\":\"%s\"},[", (ui32Alias ? "," : ""),
+                          ui32Alias,
+                          g_psAliases[g_pui32RecordAlias[ui32Alias]].pcName);
+        i32Ret = EmitRequestBody(psSend, pcField, i32Ret, &ui32Total);
+        if(i32Ret < 0)
+        {
+            return (i32Ret);
+        }
+
+        for(ui32Index = 0; ui32Index < ui32Count; ui32Index++)
+        {
+            TelemetryGet(ui32Index, &sSample);
+            if(ui32Alias == 0)
+            {
+                ui32Value = sSample.ui16Temp;
+            }
+            else if(ui32Alias == 1)
+            {
+                ui32Value = sSample.ui32Switch1;
+            }
+            else
+            {
+                ui32Value = sSample.ui32Switch2;
+            }
+
+            FormatInit(&sCursor, pcField, sizeof(pcField));
+            FormatString(&sCursor, (ui32Index ? ",[" : "["));
+            FormatDecimal(&sCursor, sSample.ui32Time);
+            FormatBytes(&sCursor, ",", 1);
+            FormatDecimal(&sCursor, ui32Value);
+            FormatBytes(&sCursor, "]", 1);
+            i32Ret = EmitRequestBody(psSend, pcField, sCursor.ui32Len,
+                                     &ui32Total);
+            if(i32Ret < 0)
+            {
+                return (i32Ret);
+            }
+        }
+
+        i32Ret = EmitRequestBody(psSend, "],{}]}", 6, &ui32Total);
+        if(i32Ret < 0)
+        {
+            return (i32Ret);
+        }
+    }
+
+    i32Ret = EmitRequestBody(psSend, "]}", 2, &ui32Total);
+    if(i32Ret < 0)
+    {
+        return (i32Ret);
+    }
+
+    return (ui32Total);
+}
+
+//*****************************************************************************
+//
+// Builds the Alias List that can be sent with the POST request.  Returns the
+// aliases in the list as a bit mask by index in g_psAliases.
+//
+//*****************************************************************************
+uint32_t
+GetAliasList(tFormatCursor *psCursor)
+{
+    uint32_t ui32Aliases = 0;
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < NUM_ALIASES; ui32Idx++)
+    {
+        if(*g_psAliases[ui32Idx].peRW == READ_ONLY)
+        {
+            FormatBytes(psCursor, (ui32Aliases ? "&" : "?"), 1);
+            FormatString(psCursor, g_psAliases[ui32Idx].pcName);
+            ui32Aliases |= (1U << ui32Idx);
+        }
+    }
+
+    return (ui32Aliases);
+}
+
+//*****************************************************************************
+//
+// Update cloud data.
+//
+//*****************************************************************************
+void
+UpdateCloudData(void)
+{
+    tFormatCursor sCursor;
+    uint32_t ui32Phase;
+
+    //
+    // Refresh the latencies that are posted to the server, in milliseconds.
+    //
+    // dns=<p95>,tcp=<p95>,tls=<p95>,send=<p95>,ttfb=<p95>,body=<p95>
+    //
+    if(g_eLatenciesRW == WRITE_ONLY)
+    {
+        FormatInit(&sCursor, g_pcLatencies, sizeof(g_pcLatencies));
+        for(ui32Phase = 0; ui32Phase < NUM_LATENCY_PHASES; ui32Phase++)
+        {
+            if(ui32Phase != 0)
+            {
+                FormatBytes(&sCursor, ",", 1);
+            }
+            FormatString(&sCursor, g_ppcLatencyPhases[ui32Phase]);
+            FormatBytes(&sCursor, "=", 1);
+            FormatDecimal(&sCursor,
+                          LatencyPercentile(&g_psLatency[ui32Phase], 95) /
+                          1000);
+        }
+    }
+
+    if(g_ui32LEDD1 != g_ui32LastLEDD1)
+    {
+        g_ui32LastLEDD1 = g_ui32LEDD1;
+        if(g_ui32LEDD1)
+        {
+            GPIO_write(Board_LED0, Board_LED_ON);
+        }
+        else
+        {
+            GPIO_write(Board_LED0, Board_LED_OFF);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Stores a value read from the server in the alias at index ui32Idx of
+// g_psAliases, if that alias is read from the server.  This must only be
+// called from the Cloud task.
+//
+//*****************************************************************************
+static void
+ApplyAliasValue(uint32_t ui32Idx, const char *pcValue)
+{
+    const tAlias *psAlias;
+
+    if((ui32Idx >= NUM_ALIASES) || (*g_psAliases[ui32Idx].peRW != READ_ONLY))
+    {
+        return;
+    }
+
+    psAlias = &g_psAliases[ui32Idx];
+    switch(psAlias->eType)
+    {
+        case Alias_Decimal:
+        case Alias_Hex:
+        {
+            *(uint32_t *)psAlias->pvStorage = strtoul(pcValue, NULL, 0);
+            break;
+        }
+
+        case Alias_Flag:
+        {
+            *(uint32_t *)psAlias->pvStorage = (pcValue[0] == '1') ? 1 : 0;
+            break;
+        }
+
+        case Alias_String:
+        {
+            strncpy(psAlias->pvStorage, pcValue, psAlias->ui32Size);
+            ((char *)psAlias->pvStorage)[psAlias->ui32Size - 1] = '\0';
+            break;
+        }
+
+        default:
+        {
+            break;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Handles one <alias>=<value> field of the response body for the GET request.
+// The alias is found through the alias hash table and must match exactly, so
+// an alias name that appears inside another value is never mistaken for a
+// field.  Values too long for the parser are ignored rather than applied
+// partially.
+//
+//*****************************************************************************
+static void
+ProcessAliasValue(const char *pcAlias, const char *pcValue, bool bTruncated)
+{
+    int32_t i32Idx;
+
+    if(bTruncated)
+    {
+        return;
+    }
+
+    i32Idx = AliasFind(pcAlias);
+    if(i32Idx >= 0)
+    {
+        ApplyAliasValue((uint32_t)i32Idx, pcValue);
+    }
+}
+
+//*****************************************************************************
+//
+// Handles one <alias>=<value> field of a long-poll response body by posting
+// it to the Cloud task, which applies it.  This waits if the Cloud task has
+// not yet applied the earlier values.
+//
+//*****************************************************************************
+static void
+LongPollAliasValue(const char *pcAlias, const char *pcValue, bool bTruncated)
+{
+    int32_t i32Idx;
+
+    if(bTruncated)
+    {
+        return;
+    }
+
+    i32Idx = AliasFind(pcAlias);
+    if(i32Idx < 0)
+    {
+        return;
+    }
+
+    g_sLongPollMsg.ui32Alias = (uint32_t)i32Idx;
+    strcpy(g_sLongPollMsg.pcValue, pcValue);
+    Mailbox_post(LongPollMailbox, &g_sLongPollMsg, BIOS_WAIT_FOREVER);
+    g_ui32LongPollValues++;
+}
+
+//*****************************************************************************
+//
+// Handles the response Body for the GET request.  The body is read in chunks
+// and parsed as it arrives, so it is never held in memory as a whole.  Each
+// <alias>=<value> field is passed to pfnHandler.  For now, the values only
+// control the LEDs, the email address and the game state.
+//
+//*****************************************************************************
+int32_t
+ProcessResponseBody(HTTPCli_Handle cli, tFormFieldHandler pfnHandler)
+{
+    tFormParser sParser;
+    char pcRecBuf[128];
+    int32_t i32Ret;
+    bool bMoreFlag;
+
+    FormParserInit(&sParser, pfnHandler);
+
+    do
+    {
+        i32Ret = HTTPCli_readResponseBody(cli, pcRecBuf, sizeof(pcRecBuf),
+                                          &bMoreFlag);
+        if(i32Ret < 0)
+        {
+            return (i32Ret);
+        }
+
+        FormParserInput(&sParser, pcRecBuf, (uint32_t)i32Ret);
+    } while (bMoreFlag);
+
+    FormParserEnd(&sParser);
+
+    return (0);
+}
+
+//*****************************************************************************
+//
+// Returns a hash (FNV-1a) of the MAC address, which differs between boards.
+//
+//*****************************************************************************
+static uint32_t
+DeviceHash(void)
+{
+    uint32_t ui32Hash = 2166136261U;
+    const char *pcChar;
+
+    for(pcChar = g_pcMACAddress; *pcChar; pcChar++)
+    {
+        ui32Hash = (ui32Hash ^ (uint8_t)*pcChar) * 16777619U;
+    }
+
+    return (ui32Hash);
+}
+
+//*****************************************************************************
+//
+// Wakes the Cloud task with the given CLOUD_EVENT_* events.  This can be
+// called from any task, Swi or Hwi.
+//
+//*****************************************************************************
+void
+CloudNotify(uint32_t ui32Events)
+{
+    Event_post(CloudEvent, ui32Events);
+}
+
+//*****************************************************************************
+//
+// Blocks the Cloud task for the given time in milliseconds or until one of
+// the CLOUD_EVENT_* events is posted, whichever comes first.  Returns the
+// events that were posted, or 0 if the time ran out.
+//
+//*****************************************************************************
+static uint32_t
+CloudWait(uint32_t ui32Ms)
+{
+    uint32_t ui32Ticks;
+
+    ui32Ticks = (ui32Ms * BIOS_TICK_RATE) / 1000;
+    if(ui32Ticks == 0)
+    {
+        ui32Ticks = 1;
+    }
+
+    return (Event_pend(CloudEvent, Event_Id_NONE, CLOUD_EVENT_ALL,
+                       ui32Ticks));
+}
+
+//*****************************************************************************
+//
+// Waits until the next sync slot of this board, that is the next multiple of
+// the sync period after the phase offset, plus a small random delay.  Unlike
+// a fixed sleep, the time spent syncing doesn't shift the slot.  The period
+// is the one last set by the server, so a change applies to the next sync.
+// The wait ends early if an event is posted, which is returned.
+//
+//*****************************************************************************
+static uint32_t
+SyncWait(void)
+{
+    uint32_t ui32Period;
+    uint32_t ui32Phase;
+    uint32_t ui32Ticks;
+
+    ui32Period = g_ui32SyncPeriod;
+    if(ui32Period == 0)
+    {
+        ui32Period = SYNC_PERIOD;
+    }
+    else if(ui32Period < SYNC_PERIOD_MIN)
+    {
+        ui32Period = SYNC_PERIOD_MIN;
+    }
+    else if(ui32Period > SYNC_PERIOD_MAX)
+    {
+        ui32Period = SYNC_PERIOD_MAX;
+    }
+
+    ui32Phase = ((DeviceHash() % ui32Period) * BIOS_TICK_RATE) / 1000;
+    ui32Period = (ui32Period * BIOS_TICK_RATE) / 1000;
+    ui32Ticks = ui32Period - ((Clock_getTicks() - ui32Phase) % ui32Period);
+    ui32Ticks += ((BackoffRandom() % SYNC_JITTER) * BIOS_TICK_RATE) / 1000;
+
+    return (CloudWait((ui32Ticks * 1000) / BIOS_TICK_RATE));
+}
+
+//*****************************************************************************
+//
+// Returns the delay in milliseconds before the next attempt after a failure.
+// This is the delay picked by the given retry policy, or the one the server
+// asked for with a Retry-After header on the connection described by
+// psKeepAlive if it is longer.  Up to an eighth is added at random to the
+// latter so the boards that were turned away together don't come back
+// together.
+//
+//*****************************************************************************
+static uint32_t
+RetryDelay(tBackoff *psBackoff, tKeepAlive *psKeepAlive)
+{
+    uint32_t ui32Delay;
+    uint32_t ui32RetryAfter;
+
+    ui32Delay = BackoffNext(psBackoff);
+
+    ui32RetryAfter = psKeepAlive->ui32RetryAfter * 1000;
+    psKeepAlive->ui32RetryAfter = 0;
+    if(ui32RetryAfter != 0)
+    {
+        ui32RetryAfter += BackoffRandom() % ((ui32RetryAfter / 8) + 1);
+        if(ui32RetryAfter > ui32Delay)
+        {
+            ui32Delay = ui32RetryAfter;
+            psBackoff->ui32LastMs = ui32Delay;
+        }
+    }
+
+    return (ui32Delay);
+}
+
+//*****************************************************************************
+//
+// Holds off the next attempt to reach the server by the delay that the given
+// retry policy picks for this failure, or the one the server asked for.
+// Returns the delay in milliseconds.
+//
+//*****************************************************************************
+static uint32_t
+CloudRetryAfter(tBackoff *psBackoff)
+{
+    uint32_t ui32Delay;
+
+    ui32Delay = RetryDelay(psBackoff, &g_sKeepAlive);
+    g_ui32RetryTicks = Clock_getTicks() + ((ui32Delay * BIOS_TICK_RATE) /
+                                           1000);
+
+    return (ui32Delay);
+}
+
+//*****************************************************************************
+//
+// Returns the time in milliseconds left before the Cloud task tries to reach
+// the server again, or 0 if it is not waiting.
+//
+//*****************************************************************************
+uint32_t
+CloudRetryRemaining(void)
+{
+    int32_t i32Ticks;
+
+    i32Ticks = (int32_t)(g_ui32RetryTicks - Clock_getTicks());
+
+    return ((i32Ticks > 0) ? (((uint32_t)i32Ticks * 1000) / BIOS_TICK_RATE) :
+            0);
+}
+
+//*****************************************************************************
+//
+// This function handles the server reported error message from functions like
+// ExositeActivate, ExositeWrite and ExositeRead.  The next attempt is delayed
+// by the server retry policy, except after a 401 where a new CIK is requested
+// right away.
+//
+//*****************************************************************************
+void CloudHandleError(int32_t i32Ret, tCloudState *pui32State)
+{
+    char * pcDebug;
+    uint32_t ui32Delay;
+    UInt uKey;
+
+    g_sDebug.ui32Request = Cmd_Prompt_Print;
+    pcDebug = g_sDebug.pcBuf;
+
+    //
+    // Check if error handling is needed.
+    //
+    if(i32Ret <= 0)
+    {
+        //
+        // No - Then retun without doing anything.
+        //
+        return;
+    }
+
+    //
+    // Check if we got a 409 (Conflict) or 404 (Not Found) error.
+    //
+    if((i32Ret == HTTPStd_CONFLICT) || (i32Ret == HTTPStd_NOT_FOUND))
+    {
+        //
+        // Yes - Print the reason for this message and try again later to get
+        // a new CIK.
+        //
+        snprintf(pcDebug, TX_BUF_SIZE, "CloudError: Server sent %s error."
+                 "\n    Check if board is added to the Exosite server.\n",
+                 ((i32Ret == HTTPStd_CONFLICT) ? "409" : "404"));
+        Mailbox_post(CloudMailbox, &g_sDebug, BIOS_NO_WAIT);
+        System_printf(pcDebug);
+
+        ui32Delay = CloudRetryAfter(&g_psBackoff[BACKOFF_SERVER]);
+        snprintf(pcDebug, TX_BUF_SIZE, "    Re-enable the device for "
+                 "provisioning on Exosite server.\n    Retrying in %d ms..."
+                 "\n", ui32Delay);
+        Mailbox_post(CloudMailbox, &g_sDebug, BIOS_NO_WAIT);
+        System_printf(pcDebug);
+
+        //
+        // Set flag to request a new CIK once the delay is over.
+        //
+        *pui32State = Cloud_Activate_CIK;
+    }
+
+    //
+    // Check if we got a 401 Not Found error.
+    //
+    else if(i32Ret == HTTPStd_UNAUTHORIZED)
+    {
+        //
+        // No or invalid CIK used during communication with server.
+        // Hence should try to get a valid CIK from server.
+        //
+        uKey = Task_disable();
+        memset(g_pcExositeCIK, 0, EXOSITE_CIK_LENGTH + 1);
+        Task_restore(uKey);
+        *pui32State = Cloud_Activate_CIK;
+        snprintf(pcDebug, TX_BUF_SIZE, "CloudError: Server sent 401 error."
+                 "\n    Invalid CIK used. Trying to acquire a new CIK.\n");
+        Mailbox_post(CloudMailbox, &g_sDebug, BIOS_NO_WAIT);
+        System_printf(pcDebug);
+    }
+
+    //
+    // Check if the server is shedding load with a 429 (Too Many Requests) or
+    // 503 (Service Unavailable) error.
+    //
+    else if((i32Ret == HTTP_TOO_MANY_REQUESTS) ||
+            (i32Ret == HTTPStd_SERVICE_UNAVAILABLE))
+    {
+        //
+        // Yes - Wait as long as the server asked for before trying again.
+        //
+        ui32Delay = CloudRetryAfter(&g_psBackoff[BACKOFF_SERVER]);
+        snprintf(pcDebug, TX_BUF_SIZE, "CloudError: Server sent %d error."
+                 "\n    Server busy. Retrying in %d ms\n", i32Ret, ui32Delay);
+        Mailbox_post(CloudMailbox, &g_sDebug, BIOS_NO_WAIT);
+        System_printf(pcDebug);
+    }
+
+    //
+    // We got some unknown error from server.
+    //
+    else
+    {
+        //
+        // Report error and try again later.
+        //
+        ui32Delay = CloudRetryAfter(&g_psBackoff[BACKOFF_SERVER]);
+        snprintf(pcDebug, TX_BUF_SIZE, "CloudError: Server returned : %d "
+                 "during : %d action. Retrying in %d ms\n", i32Ret,
+                 *pui32State, ui32Delay);
+        Mailbox_post(CloudMailbox, &g_sDebug, BIOS_NO_WAIT);
+        System_printf(pcDebug);
+    }
+}
+
+//*****************************************************************************
+//
+// Get CIK from Exosite.  The following headers and request boady
+// are sent by this function.
+//
+// POST /provision/activate HTTP/1.1
+// Host: m2.exosite.com
+// Content-Type: application/x-www-form-urlencoded; charset=utf-8
+// Content-Length: <length>
+//
+// <alias 1>=<value 1>
+//
+//*****************************************************************************
+int32_t
+ExositeActivate(HTTPCli_Handle cli)
+{
+    char pcExositeProvBuf[EXOSITE_LENGTH];
+    char pcFields[96];
+    tSendBuffer sSend;
+    tFormatCursor sCursor;
+    bool bMoreFlag;
+    int32_t i32Ret = 0;
+    uint32_t ui32Status = 0;
+    bool bCIK;
+    UInt uKey;
+
+    //
+    // Assemble the provisioning information.
+    //
+    if(BuildProvInfo("texasinstruments", "ek-tm4c129exl", g_pcMACAddress,
+                     pcExositeProvBuf, EXOSITE_LENGTH) != 0)
+    {
+        //
+        // Return error.
+        //
+        return (-2);
+    }
+
+    //
+    // Start timing the phases of this request.
+    //
+    LatencyStart(&g_sLatencyTimer);
+
+    //
+    // Make HTTP 1.1 POST request.  The following headers are automatically
+    // sent with the POST request.
+    //
+    // POST /provision/activate HTTP/1.1
+    // Host: m2.exosite.com
+    //
+    i32Ret = HTTPCli_sendRequest(cli, HTTPStd_POST, PROVISION_URI, true);
+    if(i32Ret < 0)
+    {
+        return (i32Ret);
+    }
+
+    SendBufferInit(&sSend, cli);
+
+    //
+    // Send the content type and content length headers to the send buffer.
+    //
+    // Content-Type: <type>
+    // Content-Length: <length>
+    // <blank line>
+    //
+    FormatInit(&sCursor, pcFields, sizeof(pcFields));
+    FormatField(&sCursor, HTTPStd_FIELD_NAME_CONTENT_TYPE,
+                EXOSITE_CONTENT_TYPE);
+    FormatNumberField(&sCursor, HTTPStd_FIELD_NAME_CONTENT_LENGTH,
+                      strlen(pcExositeProvBuf));
+    FormatBytes(&sCursor, "\r\n", 2);
+    i32Ret = SendBufferWrite(&sSend, pcFields, sCursor.ui32Len);
+    if(i32Ret < 0)
+    {
+        return (i32Ret);
+    }
+
+    //
+    // Send the request body and write what is left in the send buffer to end
+    // the request.
+    //
+    // vendor=<vendor>&model=<model>&sn=<MAC address>
+    //
+    i32Ret = SendBufferWrite(&sSend, pcExositeProvBuf,
+                             strlen(pcExositeProvBuf));
+    if(i32Ret == 0)
+    {
+        i32Ret = SendBufferFlush(&sSend);
+    }
+    if(i32Ret < 0)
+    {
+        return (i32Ret);
+    }
+
+    LatencyMark(&g_sLatencyTimer, LATENCY_SEND);
+
+    //
+    // Get the Exosite server's response status.
+    //
+    i32Ret = HTTPCli_getResponseStatus(cli);
+    if(i32Ret < 0)
+    {
+        return (i32Ret);
+    }
+    LatencyMark(&g_sLatencyTimer, LATENCY_FIRST_BYTE);
+    ui32Status = (uint32_t)(i32Ret);
+
+    //
+    // Read the response headers.  Only the connection management headers are
+    // kept, the rest are dropped.
+    //
+    i32Ret = ReadResponseFields(cli, &g_sKeepAlive, NULL, pcExositeProvBuf,
+                                sizeof(pcExositeProvBuf));
+    if(i32Ret < 0)
+    {
+        return (i32Ret);
+    }
+
+    //
+    // Did Exosite respond with a status other than HTTP_NO_CONTENT?
+    //
+    if(ui32Status != HTTPStd_NO_CONTENT)
+    {
+        //
+        // Yes - Then extract the Response body into a buffer.
+        //
+        do
+        {
+            i32Ret = HTTPCli_readResponseBody(cli, pcExositeProvBuf,
+                                              sizeof(pcExositeProvBuf),
+                                              &bMoreFlag);
+            if(i32Ret < 0)
+            {
+                return (i32Ret);
+            }
+            else if(i32Ret)
+            {
+                if(i32Ret < sizeof(pcExositeProvBuf))
+                {
+                    pcExositeProvBuf[i32Ret] = '\0';
+                }
+            }
+        } while (bMoreFlag);
+    }
+
+    //
+    // Did Exosite respond with a status other than HTTP_OK?
+    //
+    if(ui32Status != HTTPStd_OK)
+    {
+        //
+        // Yes - Return with the response status.
+        //
+        return (ui32Status);
+    }
+
+    //
+    // The response body is the CIK.  Save it in EEPROM for future use.
+    //
+    SaveCIKEEPROM(pcExositeProvBuf);
+
+    //
+    // The validators of the last read belong to the old CIK.
+    //
+    g_sReadValidator.ui32Aliases = 0;
+
+    //
+    // Read back the CIK from EEPROM into global resource.
+    //
+    uKey = Task_disable();
+    bCIK = GetCIKEEPROM(g_pcExositeCIK);
+    Task_restore(uKey);
+    if(bCIK != true)
+    {
+        //
+        // Error reading back CIK.  Return the error message.
+        //
+        return(-3);
+    }
+
+    //
+    // Compare the value read back from EEPROM with the value received from
+    // Exosite.
+    //
+    if(strncmp(g_pcExositeCIK, pcExositeProvBuf, EXOSITE_CIK_LENGTH) != 0)
+    {
+        //
+        // Values don't match.  Return the error message.
+        //
+        return(-4);
+    }
+
+    //
+    // Print CIK value.
+    //
+    g_sDebug.ui32Request = Cmd_Prompt_Print;
+    snprintf(g_sDebug.pcBuf, TX_BUF_SIZE, "CIK acquired: %s\r\n",
+             g_pcExositeCIK);
+    Mailbox_post(CloudMailbox, &g_sDebug, BIOS_NO_WAIT);
+    System_printf(g_sDebug.pcBuf);
+
+    //
+    // No error encountered.  Return success.
+    //
+    LatencyMark(&g_sLatencyTimer, LATENCY_BODY);
+    return(0);
+}
+
+//*****************************************************************************
+//
+// Sends the request headers that follow the request line to the send buffer.
+// This is the cached header block, with the Content-Type header if bBody is
+// set, then pcFields, which holds any per-request headers each terminated by
+// CRLF, and the blank line that ends the headers.
+//
+//*****************************************************************************
+static int32_t
+SendHeaderBlock(tSendBuffer *psSend, bool bBody, const char *pcFields)
+{
+    int32_t i32Ret;
+
+    //
+    // Serialize the constant headers again if the CIK changed since they
+    // were last built.
+    //
+    if(strcmp(g_pcHeaderCIK, g_pcExositeCIK) != 0)
+    {
+        g_ui32HeaderReadLen = snprintf(g_pcHeaderBlock,
+                                       sizeof(g_pcHeaderBlock),
+                                       "%s: %s\r\n%s: %s\r\n", EXOSITE_TYPE,
+                                       g_pcExositeCIK,
+                                       HTTPStd_FIELD_NAME_ACCEPT,
+                                       EXOSITE_CONTENT_TYPE);
+        g_ui32HeaderWriteLen = g_ui32HeaderReadLen +
+                               snprintf((g_pcHeaderBlock +
+                                         g_ui32HeaderReadLen),
+                                        (sizeof(g_pcHeaderBlock) -
+                                         g_ui32HeaderReadLen),
+                                        "%s: %s\r\n",
+                                        HTTPStd_FIELD_NAME_CONTENT_TYPE,
+                                        EXOSITE_CONTENT_TYPE);
+        strcpy(g_pcHeaderCIK, g_pcExositeCIK);
+    }
+
+    i32Ret = SendBufferWrite(psSend, g_pcHeaderBlock,
+                             (bBody ? g_ui32HeaderWriteLen :
+                              g_ui32HeaderReadLen));
+    if(i32Ret == 0)
+    {
+        i32Ret = SendBufferWrite(psSend, pcFields, strlen(pcFields));
+    }
+    if(i32Ret == 0)
+    {
+        i32Ret = SendBufferWrite(psSend, "\r\n", 2);
+    }
+
+    return (i32Ret);
+}
+
+//*****************************************************************************
+//
+// Writes (or POSTs) data to Exosite.  The following headers and request boady
+// are sent by this function.
+//
+// POST /onep:v1/stack/alias HTTP/1.1
+// Host: m2.exosite.com
+// X-Exosite-CIK: <CIK>
+// Accept: application/x-www-form-urlencoded; charset=utf-8
+// Content-Type: application/x-www-form-urlencoded; charset=utf-8
+// Content-Length: <length>
+//
+// <alias 1>=<value 1>&<alias 2...>=<value 2...>&<alias n>=<value n>
+//
+// The response is read separately by ExositeWriteResponse().
+//
+//*****************************************************************************
+int32_t
+ExositeWriteRequest(HTTPCli_Handle cli, tRequestBody *psBody)
+{
+    int32_t i32Ret = 0;
+    char pcField[32];
+    tSendBuffer sSend;
+    tFormatCursor sCursor;
+
+    //
+    // Make sure that CIK is filled before proceeding.
+    //
+    if(g_pcExositeCIK[0] == '\0')
+    {
+        //
+        // CIK is not populated.  Return this error.
+        //
+        return -1;
+    }
+
+    //
+    // Start timing the phases of this request.
+    //
+    LatencyStart(&g_sLatencyTimer);
+
+    //
+    // Make HTTP 1.1 POST request.  The following headers are automatically
+    // sent with the POST request.
+    //
+    // POST /onep:v1/stack/alias HTTP/1.1
+    // Host: m2.exosite.com
+    //
+    i32Ret = HTTPCli_sendRequest(cli, HTTPStd_POST, EXOSITE_URI, true);
+    if(i32Ret < 0)
+    {
+        return (i32Ret);
+    }
+
+    SendBufferInit(&sSend, cli);
+
+    //
+    // Send the headers to the send buffer.
+    //
+    // X-Exosite-CIK: <CIK>
+    // Accept: application/x-www-form-urlencoded; charset=utf-8
+    // Content-Type: application/x-www-form-urlencoded; charset=utf-8
+    // Content-Length: <length>
+    // <blank line>
+    //
+    FormatInit(&sCursor, pcField, sizeof(pcField));
+    FormatNumberField(&sCursor, HTTPStd_FIELD_NAME_CONTENT_LENGTH,
+                      WriteRequestBody(NULL, psBody));
+    i32Ret = SendHeaderBlock(&sSend, true, pcField);
+    if(i32Ret < 0)
+    {
+        return (i32Ret);
+    }
+
+    //
+    // Send the request body.
+    //
+    // <alias 1>=<value 1>&<alias 2...>=<value 2...>&<alias n>=<value n>
+    //
+    i32Ret = WriteRequestBody(&sSend, psBody);
+    if(i32Ret < 0)
+    {
+        return (i32Ret);
+    }
+
+    //
+    // Write what is left in the send buffer to end the request.
+    //
+    i32Ret = SendBufferFlush(&sSend);
+    if(i32Ret < 0)
+    {
+        return (i32Ret);
+    }
+
+    LatencyMark(&g_sLatencyTimer, LATENCY_SEND);
+
+    return(0);
+}
+
+//*****************************************************************************
+//
+// Reads the response to the request sent by ExositeWriteRequest().  Returns 0
+// on success, the response status if it is not the expected one, or a
+// negative HTTPCli error.
+//
+//*****************************************************************************
+int32_t
+ExositeWriteResponse(HTTPCli_Handle cli)
+{
+    int32_t i32Ret = 0;
+    uint32_t ui32Status = 0;
+    char pcDataBuf[128];
+    bool bMoreFlag;
+
+    //
+    // Get the response status and back it up.
+    //
+    i32Ret = HTTPCli_getResponseStatus(cli);
+    if(i32Ret < 0)
+    {
+        return (i32Ret);
+    }
+    LatencyMark(&g_sLatencyTimer, LATENCY_FIRST_BYTE);
+    ui32Status = (uint32_t)(i32Ret);
+
+    //
+    // Read the response headers.  Only the connection management headers are
+    // kept, the rest are dropped.
+    //
+    // Date: <date>
+    // Server: <server>
+    // Connection: Close
+    // Content-Length: 0
+    // <blank line>
+    //
+    i32Ret = ReadResponseFields(cli, &g_sKeepAlive, NULL, pcDataBuf,
+                                sizeof(pcDataBuf));
+    if(i32Ret < 0)
+    {
+        return (i32Ret);
+    }
+
+    //
+    // Did Exosite respond with an undesired status?
+    //
+    if(ui32Status != HTTPStd_NO_CONTENT)
+    {
+        //
+        // Yes - Now extract the Response body into a buffer.  Even though we
+        // don't need this response body, we need to clean up for next HTTP
+        // request.
+        //
+        do
+        {
+            i32Ret = HTTPCli_readResponseBody(cli, pcDataBuf,
+                                              sizeof(pcDataBuf), &bMoreFlag);
+            if(i32Ret < 0)
+            {
+                return (i32Ret);
+            }
+            else if(i32Ret)
+            {
+                if(i32Ret < sizeof(pcDataBuf))
+                {
+                    pcDataBuf[i32Ret] = '\0';
+                }
+            }
+        } while (bMoreFlag);
+
+        //
+        // Yes - Return the response status.
+        //
+        return (ui32Status);
     }
+
+    //
+    // Received the desired response status from server.  Hence return 0.
+    //
+    LatencyMark(&g_sLatencyTimer, LATENCY_BODY);
+    return(0);
 }
 
 //*****************************************************************************
 //
-// Builds the Alias List that can be sent with the POST request.
+// Writes (or POSTs) data to Exosite and waits for the response.
 //
 //*****************************************************************************
-void
-GetAliasList(char* pcDataBuf, uint32_t ui32DataBufLen)
+int32_t
+ExositeWrite(HTTPCli_Handle cli, tRequestBody *psBody)
 {
-    uint32_t ui32DataLen = 0;
+    int32_t i32Ret;
 
-    ui32DataLen = snprintf(pcDataBuf, ui32DataBufLen, "?location");
-    if(g_eLEDD1RW == READ_ONLY)
-    {
-        ui32DataLen += snprintf((pcDataBuf + ui32DataLen),
-                                (ui32DataBufLen - ui32DataLen), "&ledd1");
-    }
-    if(g_eBoardStaeRW == READ_ONLY)
-    {
-        ui32DataLen += snprintf((pcDataBuf + ui32DataLen),
-                                (ui32DataBufLen - ui32DataLen), "&gamestate");
-    }
-    if(g_eEmailRW == READ_ONLY)
+    i32Ret = ExositeWriteRequest(cli, psBody);
+    if(i32Ret != 0)
     {
-        ui32DataLen += snprintf((pcDataBuf + ui32DataLen),
-                                (ui32DataBufLen - ui32DataLen), "&emailaddr");
+        return (i32Ret);
     }
+
+    return (ExositeWriteResponse(cli));
 }
 
 //*****************************************************************************
 //
-// Update cloud data.
+// Reads (or GETs) data from Exosite.  The following headers are sent by this
+// function.
+//
+// GET /onep:v1/stack/alias?ledd1&ledd2&location HTTP/1.1
+// Host: m2.exosite.com
+// X-Exosite-CIK: <CIK>
+// Accept: application/x-www-form-urlencoded; charset=utf-8
+//
+// The response is read separately by ExositeReadResponse().
 //
 //*****************************************************************************
-void
-UpdateCloudData(void)
+int32_t
+ExositeReadRequest(HTTPCli_Handle cli)
 {
-    if(g_ui32LEDD1 != g_ui32LastLEDD1)
+    int32_t i32Ret = 0;
+    char pcRecBuf[128];
+    char pcFields[(VALIDATOR_SIZE * 2) + 40];
+    tSendBuffer sSend;
+    tFormatCursor sCursor;
+
+    //
+    // Make sure that CIK is filled before proceeding.
+    //
+    if(g_pcExositeCIK[0] == '\0')
     {
-        g_ui32LastLEDD1 = g_ui32LEDD1;
-        if(g_ui32LEDD1)
+        //
+        // CIK is not populated.  Return this error.
+        //
+        return -1;
+    }
+
+    //
+    // Copy Exosite URI into a buffer.
+    //
+    FormatInit(&sCursor, pcRecBuf, sizeof(pcRecBuf));
+    FormatString(&sCursor, EXOSITE_URI);
+
+    //
+    // Get the alias list whose values we need from the cloud server.
+    //
+    g_ui32ReadAliases = GetAliasList(&sCursor);
+
+    //
+    // Start timing the phases of this request.
+    //
+    LatencyStart(&g_sLatencyTimer);
+
+    //
+    // Make HTTP 1.1 GET request.  The following headers are automatically
+    // sent with the GET request.
+    //
+    // GET /onep:v1/stack/alias?ledd1&location&gamestate&emailaddr HTTP/1.1
+    // Host: m2.exosite.com
+    //
+    i32Ret = HTTPCli_sendRequest(cli, HTTPStd_GET, pcRecBuf, true);
+    if(i32Ret < 0)
+    {
+        return (i32Ret);
+    }
+
+    SendBufferInit(&sSend, cli);
+
+    //
+    // If the last read of the same aliases returned validators, send them
+    // back so the server can skip the body if nothing changed.
+    //
+    FormatInit(&sCursor, pcFields, sizeof(pcFields));
+    if(g_sReadValidator.ui32Aliases == g_ui32ReadAliases)
+    {
+        if(g_sReadValidator.pcETag[0] != '\0')
         {
-            GPIO_write(Board_LED0, Board_LED_ON);
+            FormatField(&sCursor, "If-None-Match", g_sReadValidator.pcETag);
         }
-        else
+        if(g_sReadValidator.pcLastModified[0] != '\0')
         {
-            GPIO_write(Board_LED0, Board_LED_OFF);
+            FormatField(&sCursor, "If-Modified-Since",
+                        g_sReadValidator.pcLastModified);
         }
     }
+
+    //
+    // Send the headers to the send buffer.
+    //
+    // X-Exosite-CIK: <CIK>
+    // Accept: application/x-www-form-urlencoded; charset=utf-8
+    // If-None-Match: <ETag> (optional)
+    // If-Modified-Since: <Last-Modified> (optional)
+    // <blank line>
+    //
+    i32Ret = SendHeaderBlock(&sSend, false, pcFields);
+    if(i32Ret < 0)
+    {
+        return (i32Ret);
+    }
+
+    //
+    // Write what is left in the send buffer to end the request.
+    //
+    i32Ret = SendBufferFlush(&sSend);
+    if(i32Ret < 0)
+    {
+        return (i32Ret);
+    }
+
+    LatencyMark(&g_sLatencyTimer, LATENCY_SEND);
+
+    return(0);
 }
 
 //*****************************************************************************
 //
-// Handles the response Body for the GET request.  For now, this only controls
-// the LEDs.
+// Reads the response to the request sent by ExositeReadRequest() and
+// processes the alias values in it.  A 304 Not Modified response to a
+// conditional read has no body and leaves the values as they are.  Returns 0
+// on success, the response status if it is not the expected one, or a
+// negative HTTPCli error.
 //
 //*****************************************************************************
-void
-ProcessResponseBody(char *pcBuf)
+int32_t
+ExositeReadResponse(HTTPCli_Handle cli)
 {
-    uint32_t ui32Index, j;
-    char *pcValueStart = NULL;
-    char ppcValueBuf[ALIAS_PROCESSING][VALUEBUF_SIZE];
+    int32_t i32Ret = 0;
+    uint32_t ui32Status = 0;
+    char pcRecBuf[128];
+    tReadValidator sValidator;
+    bool bMoreFlag;
 
     //
-    // For now only look for the first two values of the Alias.
+    // Get the response status and back it up.
     //
-    for(ui32Index = 0; ui32Index < ALIAS_PROCESSING; ui32Index++)
+    i32Ret = HTTPCli_getResponseStatus(cli);
+    if(i32Ret < 0)
     {
-        //
-        // Search the alias in the buffer.
-        //
-        pcValueStart = strstr(pcBuf, g_ppcGETAlias[ui32Index]);
-
-        //
-        // If we could not find the alias in the buffer, continue to the next
-        // value.
-        //
-        if(!pcValueStart)
-        {
-            continue;
-        }
-
-        //
-        // Find the equals-sign, which should be just before the start of the
-        // value.
-        //
-        pcValueStart = strstr(pcValueStart, "=");
+        return (i32Ret);
+    }
+    LatencyMark(&g_sLatencyTimer, LATENCY_FIRST_BYTE);
+    ui32Status = i32Ret;
 
-        //
-        // If we could not find the equals-sign in the buffer, continue to the
-        // next value.
-        //
-        if(!pcValueStart)
-        {
-            continue;
-        }
+    //
+    // Read the response headers.  Only the connection management headers and
+    // the validators are kept, the rest are dropped.
+    //
+    sValidator.pcETag[0] = '\0';
+    sValidator.pcLastModified[0] = '\0';
+    i32Ret = ReadResponseFields(cli, &g_sKeepAlive, &sValidator, pcRecBuf,
+                                sizeof(pcRecBuf));
+    if(i32Ret < 0)
+    {
+        return (i32Ret);
+    }
 
-        //
-        // Advance to the first character of the value.
-        //
-        pcValueStart++;
+    //
+    // None of the values changed since the last read, so there is no body
+    // to process.
+    //
+    if((ui32Status == HTTPStd_NOT_MODIFIED) &&
+       (g_sReadValidator.ui32Aliases == g_ui32ReadAliases))
+    {
+        g_ui32ReadsNotModified++;
+        LatencyMark(&g_sLatencyTimer, LATENCY_BODY);
+        return (0);
+    }
 
+    //
+    // Did Exosite respond with an undesired response?
+    //
+    if(ui32Status != HTTPStd_OK)
+    {
         //
-        // Loop through the buffer to reach the end of the input value and copy
-        // characters to the destination string.
+        // Yes - Flush the response body to clean up for the next HTTP request
+        // and return with the response status.
         //
-        j = 0;
-        while(j < VALUEBUF_SIZE)
+        do
         {
-            //
-            // Check for the end of the value string.
-            //
-            if((pcValueStart[j] == '&') ||
-               (pcValueStart[j] == 0))
-            {
-                //
-                // If we have reached the end of the value, null-terminate the
-                // destination string, and return.
-                //
-                ppcValueBuf[ui32Index][j] = 0;
-                break;
-            }
-            else
+            i32Ret = HTTPCli_readResponseBody(cli, pcRecBuf,
+                                              sizeof(pcRecBuf), &bMoreFlag);
+            if(i32Ret < 0)
             {
-                ppcValueBuf[ui32Index][j] = pcValueStart[j];
+                return (i32Ret);
             }
+        } while (bMoreFlag);
 
-            j++;
-        }
+        return (ui32Status);
+    }
+
+    //
+    // Parse the response body as it is read and perform necessary actions
+    // based on the content.
+    //
+    g_sReadValidator.ui32Aliases = 0;
+    i32Ret = ProcessResponseBody(cli, ProcessAliasValue);
+    if(i32Ret < 0)
+    {
+        return (i32Ret);
     }
-    for(ui32Index = 0; ui32Index < ALIAS_PROCESSING; ui32Index++)
+
+    //
+    // Keep the validators of this read for the next one, now that the values
+    // they stand for have been applied.
+    //
+    if((sValidator.pcETag[0] != '\0') ||
+       (sValidator.pcLastModified[0] != '\0'))
     {
-        if(strncmp(g_ppcGETAlias[ui32Index], "ledd1", 15) == 0)
-        {
-            if(g_eLEDD1RW == READ_ONLY)
-            {
-                g_ui32LEDD1 = (ppcValueBuf[ui32Index][0] == '1') ? 1 : 0;
-            }
-        }
-        else if(strncmp(g_ppcGETAlias[ui32Index], "emailaddr", 15) == 0)
-        {
-            if(g_eEmailRW == READ_ONLY)
-            {
-                strncpy(g_pcEmail, ppcValueBuf[ui32Index], sizeof(g_pcEmail));
-                g_pcEmail[99] = '\0';
-            }
-        }
-        else if(strncmp(g_ppcGETAlias[ui32Index], "gamestate", 15) == 0)
-        {
-            if(g_eBoardStaeRW == READ_ONLY)
-            {
-                g_ui32BoardState = strtoul(ppcValueBuf[ui32Index], NULL, 0);
-            }
-        }
+        sValidator.ui32Aliases = g_ui32ReadAliases;
+        g_sReadValidator = sValidator;
     }
+
+    //
+    // Received the desired response status from server.  Hence return 0.
+    //
+    LatencyMark(&g_sLatencyTimer, LATENCY_BODY);
+    return(0);
 }
 
 //*****************************************************************************
 //
-// This function handles the server reported error message from functions like
-// ExositeActivate, ExositeWrite and ExositeRead.
+// Reads (or GETs) data from Exosite and waits for the response.
 //
 //*****************************************************************************
-void CloudHandleError(int32_t i32Ret, tCloudState *pui32State)
+int32_t
+ExositeRead(HTTPCli_Handle cli)
 {
-    char * pcDebug;
-
-    g_sDebug.ui32Request = Cmd_Prompt_Print;
-    pcDebug = g_sDebug.pcBuf;
+    int32_t i32Ret;
 
-    //
-    // Check if error handling is needed.
-    //
-    if(i32Ret <= 0)
+    i32Ret = ExositeReadRequest(cli);
+    if(i32Ret != 0)
     {
-        //
-        // No - Then retun without doing anything.
-        //
-        return;
+        return (i32Ret);
     }
 
+    return (ExositeReadResponse(cli));
+}
+
+//*****************************************************************************
+//
+// Writes data to and reads data from Exosite with two requests that are sent
+// back-to-back on the same connection, without waiting for the response to
+// the first.  The responses are then read in the order of the requests.
+//
+//*****************************************************************************
+int32_t
+ExositePipelined(HTTPCli_Handle cli, tRequestBody *psBody)
+{
+    int32_t i32Ret;
+    int32_t i32WriteRet;
+
     //
-    // Check if we got a 409 (Conflict) or 404 (Not Found) error.
+    // Send both requests.
     //
-    if((i32Ret == HTTPStd_CONFLICT) || (i32Ret == HTTPStd_NOT_FOUND))
+    i32Ret = ExositeWriteRequest(cli, psBody);
+    if(i32Ret != 0)
     {
-        //
-        // Yes - Print the reason for this message and try after 10 secs to get
-        // a new CIK.
-        //
-        snprintf(pcDebug, TX_BUF_SIZE, "CloudError: Server sent %s error."
-                 "\n    Check if board is added to the Exosite server.\n",
-                 ((i32Ret == HTTPStd_CONFLICT) ? "409" : "404"));
-        Mailbox_post(CloudMailbox, &g_sDebug, BIOS_NO_WAIT);
-        System_printf(pcDebug);
-
-        snprintf(pcDebug, TX_BUF_SIZE, "    Re-enable the device for "
-                 "provisioning on Exosite server.\n    Retrying in 10 secs..."
-                 "\n");
-        Mailbox_post(CloudMailbox, &g_sDebug, BIOS_NO_WAIT);
-        System_printf(pcDebug);
+        return (i32Ret);
+    }
 
-        //
-        // Sleep for 10 secs and set flag to request a new CIK.
-        //
-        Task_sleep(10000);
-        *pui32State = Cloud_Activate_CIK;
+    i32Ret = ExositeReadRequest(cli);
+    if(i32Ret != 0)
+    {
+        return (i32Ret);
     }
 
     //
-    // Check if we got a 401 Not Found error.
+    // Read the response to the write.  If the server returned an error
+    // status, the response to the read must still be consumed before the
+    // connection can be used again.
     //
-    else if(i32Ret == HTTPStd_UNAUTHORIZED)
+    i32WriteRet = ExositeWriteResponse(cli);
+    if(i32WriteRet < 0)
     {
         //
-        // No or invalid CIK used during communication with server.
-        // Hence should try to get a valid CIK from server.
+        // The response to the read is still pending behind whatever is left
+        // of this one, so the connection can't be used again.
         //
-        memset(g_pcExositeCIK, 0, EXOSITE_CIK_LENGTH + 1);
-        *pui32State = Cloud_Activate_CIK;
-        snprintf(pcDebug, TX_BUF_SIZE, "CloudError: Server sent 401 error."
-                 "\n    Invalid CIK used. Trying to acquire a new CIK.\n");
-        Mailbox_post(CloudMailbox, &g_sDebug, BIOS_NO_WAIT);
-        System_printf(pcDebug);
+        g_sKeepAlive.bClose = true;
+        return (i32WriteRet);
     }
 
     //
-    // We got some unknown error from server.
+    // Read the response to the read and process it.  If that fails part way,
+    // the rest of it is still pending and the connection can't be used
+    // again.
     //
-    else
+    i32Ret = ExositeReadResponse(cli);
+    if(i32Ret < 0)
     {
-        //
-        // Report error and try again.
-        //
-        snprintf(pcDebug, TX_BUF_SIZE, "CloudError: Server returned : %d "
-                 "during : %d action. Retrying\n", i32Ret, *pui32State);
-        Mailbox_post(CloudMailbox, &g_sDebug, BIOS_NO_WAIT);
-        System_printf(pcDebug);
+        g_sKeepAlive.bClose = true;
+        return (i32Ret);
     }
+
+    return ((i32WriteRet != 0) ? i32WriteRet : i32Ret);
 }
 
 //*****************************************************************************
 //
-// Get CIK from Exosite.  The following headers and request boady
-// are sent by this function.
+// Writes data to and reads data from Exosite with a single request.  Exosite
+// performs the write before the read, so an alias written here is read back
+// with its new value.  The following headers and request body are sent by
+// this function.
 //
-// POST /provision/activate HTTP/1.1
+// POST /onep:v1/stack/alias?location&ledd1&gamestate&emailaddr HTTP/1.1
 // Host: m2.exosite.com
+// X-Exosite-CIK: <CIK>
 // Content-Type: application/x-www-form-urlencoded; charset=utf-8
+// Accept: application/x-www-form-urlencoded; charset=utf-8
 // Content-Length: <length>
 //
-// <alias 1>=<value 1>
+// <alias 1>=<value 1>&<alias 2...>=<value 2...>&<alias n>=<value n>
 //
 //*****************************************************************************
 int32_t
-ExositeActivate(HTTPCli_Handle cli)
+ExositeSync(HTTPCli_Handle cli, tRequestBody *psBody)
 {
-    char pcExositeProvBuf[EXOSITE_LENGTH];
-    char pcLen[4];
-    bool bMoreFlag;
     int32_t i32Ret = 0;
     uint32_t ui32Status = 0;
+    char pcDataBuf[128];
+    char pcURIBuf[128];
+    char pcField[32];
+    bool bMoreFlag;
+    tSendBuffer sSend;
+    tFormatCursor sCursor;
 
     //
-    // Assemble the provisioning information.
+    // Make sure that CIK is filled before proceeding.
     //
-    if(BuildProvInfo("texasinstruments", "ek-tm4c129exl", g_pcMACAddress,
-                     pcExositeProvBuf, EXOSITE_LENGTH) != 0)
+    if(g_pcExositeCIK[0] == '\0')
     {
         //
-        // Return error.
+        // CIK is not populated.  Return this error.
         //
-        return (-2);
+        return -1;
     }
 
     //
-    // Compute length of the Provision request body.
+    // Build the URI with the alias list whose values we need from the cloud
+    // server.
+    //
+    FormatInit(&sCursor, pcURIBuf, sizeof(pcURIBuf));
+    FormatString(&sCursor, EXOSITE_URI);
+    GetAliasList(&sCursor);
+
+    //
+    // Start timing the phases of this request.
     //
-    snprintf(pcLen, sizeof(pcLen), "%d", strlen(pcExositeProvBuf));
+    LatencyStart(&g_sLatencyTimer);
 
     //
     // Make HTTP 1.1 POST request.  The following headers are automatically
     // sent with the POST request.
     //
-    // POST /provision/activate HTTP/1.1
+    // POST /onep:v1/stack/alias?location&ledd1&gamestate&emailaddr HTTP/1.1
     // Host: m2.exosite.com
     //
-    i32Ret = HTTPCli_sendRequest(cli, HTTPStd_POST, PROVISION_URI, true);
+    i32Ret = HTTPCli_sendRequest(cli, HTTPStd_POST, pcURIBuf, true);
     if(i32Ret < 0)
     {
         return (i32Ret);
     }
 
+    SendBufferInit(&sSend, cli);
+
     //
-    // Send content type header.
+    // Send the headers to the send buffer.
     //
-    // Content-type: <type>
+    // X-Exosite-CIK: <CIK>
+    // Accept: application/x-www-form-urlencoded; charset=utf-8
+    // Content-Type: application/x-www-form-urlencoded; charset=utf-8
+    // Content-Length: <length>
     // <blank line>
     //
-    i32Ret = HTTPCli_sendField(cli, HTTPStd_FIELD_NAME_CONTENT_TYPE,
-                            EXOSITE_CONTENT_TYPE, false);
+    FormatInit(&sCursor, pcField, sizeof(pcField));
+    FormatNumberField(&sCursor, HTTPStd_FIELD_NAME_CONTENT_LENGTH,
+                      WriteRequestBody(NULL, psBody));
+    i32Ret = SendHeaderBlock(&sSend, true, pcField);
     if(i32Ret < 0)
     {
         return (i32Ret);
     }
 
     //
-    // Send content length header.
+    // Send the request body.
     //
-    // Content-Length: <length>
-    // <blank line>
+    // <alias 1>=<value 1>&<alias 2...>=<value 2...>&<alias n>=<value n>
     //
-    i32Ret = HTTPCli_sendField(cli, HTTPStd_FIELD_NAME_CONTENT_LENGTH, pcLen,
-                            true);
+    i32Ret = WriteRequestBody(&sSend, psBody);
     if(i32Ret < 0)
     {
         return (i32Ret);
     }
 
     //
-    // Send the request body.
-    //
-    // <alias 1>=<value 1>&<alias 2...>=<value 2...>&<alias n>=<value n>
+    // Write what is left in the send buffer to end the request.
     //
-    i32Ret = HTTPCli_sendRequestBody(cli, pcExositeProvBuf,
-                                  strlen(pcExositeProvBuf));
+    i32Ret = SendBufferFlush(&sSend);
     if(i32Ret < 0)
     {
         return (i32Ret);
     }
 
+    LatencyMark(&g_sLatencyTimer, LATENCY_SEND);
+
     //
-    // Get the Exosite server's response status.
+    // Get the response status and back it up.
     //
     i32Ret = HTTPCli_getResponseStatus(cli);
     if(i32Ret < 0)
     {
         return (i32Ret);
     }
+    LatencyMark(&g_sLatencyTimer, LATENCY_FIRST_BYTE);
     ui32Status = (uint32_t)(i32Ret);
 
     //
-    // Flush the remaining headers.  No field headers set using
-    // HTTPCli_setResponseFieldId(), so a call to
-    // HTTPCli_getResponseField() should drop all headers and return
-    // HTTPCli_FIELD_ID_END.
+    // Read the response headers.  Only the connection management headers are
+    // kept, the rest are dropped.
     //
-    i32Ret = HTTPCli_getResponseField(cli, pcExositeProvBuf,
-                                   sizeof(pcExositeProvBuf), &bMoreFlag);
-    if((i32Ret != HTTPCli_FIELD_ID_END) && (i32Ret != HTTPCli_FIELD_ID_DUMMY))
+    i32Ret = ReadResponseFields(cli, &g_sKeepAlive, NULL, pcDataBuf,
+                                sizeof(pcDataBuf));
+    if(i32Ret < 0)
     {
         return (i32Ret);
     }
 
     //
-    // Did Exosite respond with a status other than HTTP_NO_CONTENT?
+    // A 204 means that none of the requested aliases have a value, so there
+    // is no response body.
     //
-    if(ui32Status != HTTPStd_NO_CONTENT)
+    if(ui32Status == HTTPStd_NO_CONTENT)
+    {
+        LatencyMark(&g_sLatencyTimer, LATENCY_BODY);
+        return (0);
+    }
+
+    //
+    // Did Exosite respond with an undesired response?
+    //
+    if(ui32Status != HTTPStd_OK)
     {
         //
-        // Yes - Then extract the Response body into a buffer.
+        // Yes - Flush the response body to clean up for the next HTTP request
+        // and return with the response status.
         //
         do
         {
-            i32Ret = HTTPCli_readResponseBody(cli, pcExositeProvBuf,
-                                              sizeof(pcExositeProvBuf),
-                                              &bMoreFlag);
+            i32Ret = HTTPCli_readResponseBody(cli, pcDataBuf,
+                                              sizeof(pcDataBuf), &bMoreFlag);
             if(i32Ret < 0)
             {
                 return (i32Ret);
             }
-            else if(i32Ret)
-            {
-                if(i32Ret < sizeof(pcExositeProvBuf))
-                {
-                    pcExositeProvBuf[i32Ret] = '\0';
-                }
-            }
         } while (bMoreFlag);
-    }
 
-    //
-    // Did Exosite respond with a status other than HTTP_OK?
-    //
-    if(ui32Status != HTTPStd_OK)
-    {
-        //
-        // Yes - Return with the response status.
-        //
         return (ui32Status);
     }
 
     //
-    // The response body is the CIK.  Save it in EEPROM for future use.
-    //
-    SaveCIKEEPROM(pcExositeProvBuf);
-
-    //
-    // Read back the CIK from EEPROM into global resource.
-    //
-    if(GetCIKEEPROM(g_pcExositeCIK) != true)
-    {
-        //
-        // Error reading back CIK.  Return the error message.
-        //
-        return(-3);
-    }
-
-    //
-    // Compare the value read back from EEPROM with the value received from
-    // Exosite.
+    // Parse the response body as it is read and perform necessary actions
+    // based on the content.
     //
-    if(strncmp(g_pcExositeCIK, pcExositeProvBuf, EXOSITE_CIK_LENGTH) != 0)
+    i32Ret = ProcessResponseBody(cli, ProcessAliasValue);
+    if(i32Ret < 0)
     {
-        //
-        // Values don't match.  Return the error message.
-        //
-        return(-4);
+        return (i32Ret);
     }
 
     //
-    // Print CIK value.
-    //
-    g_sDebug.ui32Request = Cmd_Prompt_Print;
-    snprintf(g_sDebug.pcBuf, TX_BUF_SIZE, "CIK acquired: %s\r\n",
-             g_pcExositeCIK);
-    Mailbox_post(CloudMailbox, &g_sDebug, BIOS_NO_WAIT);
-    System_printf(g_sDebug.pcBuf);
-
-    //
-    // No error encountered.  Return success.
+    // Received the desired response status from server.  Hence return 0.
     //
+    LatencyMark(&g_sLatencyTimer, LATENCY_BODY);
     return(0);
 }
 
 //*****************************************************************************
 //
-// Writes (or POSTs) data to Exosite.  The following headers and request boady
+// Uploads the oldest ui32Count samples from the telemetry buffer with a
+// single record call of the RPC API.  The following headers and request body
 // are sent by this function.
 //
-// POST /onep:v1/stack/alias HTTP/1.1
+// POST /onep:v1/rpc/process HTTP/1.1
 // Host: m2.exosite.com
-// X-Exosite-CIK: <CIK>
-// Content-Type: application/x-www-form-urlencoded; charset=utf-8
+// Content-Type: application/json; charset=utf-8
 // Content-Length: <length>
 //
-// <alias 1>=<value 1>&<alias 2...>=<value 2...>&<alias n>=<value n>
+// {"auth":{"cik":"<CIK>"},"calls":[...]}
+//
+// The samples are removed from the buffer once the server has responded,
+// even if it rejected some of the calls, so that a bad sample can't block
+// the upload of the following ones.
 //
 //*****************************************************************************
 int32_t
-ExositeWrite(HTTPCli_Handle cli)
+ExositeRecord(HTTPCli_Handle cli, uint32_t ui32Count)
 {
+    static const char pcCallOK[] = "\"status\":\"ok\"";
     int32_t i32Ret = 0;
     uint32_t ui32Status = 0;
+    uint32_t ui32Match, ui32CallsOK, ui32Idx;
     char pcDataBuf[128];
-    char pcLen[8];
+    tSendBuffer sSend;
+    tFormatCursor sCursor;
     bool bMoreFlag;
 
     //
@@ -1048,73 +3509,59 @@ ExositeWrite(HTTPCli_Handle cli)
     }
 
     //
-    // Fill-up the request body and the content length.
+    // Start timing the phases of this request.
     //
-    GetRequestBody(pcDataBuf, sizeof(pcDataBuf));
-    snprintf(pcLen, sizeof(pcLen), "%d", strlen(pcDataBuf));
+    LatencyStart(&g_sLatencyTimer);
 
     //
     // Make HTTP 1.1 POST request.  The following headers are automatically
     // sent with the POST request.
     //
-    // POST /onep:v1/stack/alias HTTP/1.1
+    // POST /onep:v1/rpc/process HTTP/1.1
     // Host: m2.exosite.com
     //
-    i32Ret = HTTPCli_sendRequest(cli, HTTPStd_POST, EXOSITE_URI, true);
+    i32Ret = HTTPCli_sendRequest(cli, HTTPStd_POST, EXOSITE_RPC_URI, true);
     if(i32Ret < 0)
     {
         return (i32Ret);
     }
 
-    //
-    // Send X-Exosite-CIK header
-    //
-    // X-Exosite-CIK: <CIK>
-    // <blank line>
-    //
-    i32Ret = HTTPCli_sendField(cli, EXOSITE_TYPE, g_pcExositeCIK, false);
-    if(i32Ret < 0)
-    {
-        return (i32Ret);
-    }
+    SendBufferInit(&sSend, cli);
 
     //
-    // Send content type header
+    // Send the content type and content length headers to the send buffer.
     //
-    // Content-Type: application/x-www-form-urlencoded; charset=utf-8
+    // Content-Type: application/json; charset=utf-8
+    // Content-Length: <length>
     // <blank line>
     //
-    i32Ret = HTTPCli_sendField(cli, HTTPStd_FIELD_NAME_CONTENT_TYPE,
-                            EXOSITE_CONTENT_TYPE, false);
+    FormatInit(&sCursor, pcDataBuf, sizeof(pcDataBuf));
+    FormatField(&sCursor, HTTPStd_FIELD_NAME_CONTENT_TYPE, EXOSITE_JSON_TYPE);
+    FormatNumberField(&sCursor, HTTPStd_FIELD_NAME_CONTENT_LENGTH,
+                      WriteRecordBody(NULL, ui32Count));
+    FormatBytes(&sCursor, "\r\n", 2);
+    i32Ret = SendBufferWrite(&sSend, pcDataBuf, sCursor.ui32Len);
     if(i32Ret < 0)
     {
         return (i32Ret);
     }
 
     //
-    // Send content length header
-    //
-    // Content-Length: <length>
-    // <blank line>
+    // Send the request body and write what is left in the send buffer to end
+    // the request.
     //
-    i32Ret = HTTPCli_sendField(cli, HTTPStd_FIELD_NAME_CONTENT_LENGTH, pcLen,
-                            true);
-    if(i32Ret < 0)
+    i32Ret = WriteRecordBody(&sSend, ui32Count);
+    if(i32Ret >= 0)
     {
-        return (i32Ret);
+        i32Ret = SendBufferFlush(&sSend);
     }
-
-    //
-    // Send the request body.
-    //
-    // <alias 1>=<value 1>&<alias 2...>=<value 2...>&<alias n>=<value n>
-    //
-    i32Ret = HTTPCli_sendRequestBody(cli, pcDataBuf, strlen(pcDataBuf));
     if(i32Ret < 0)
     {
         return (i32Ret);
     }
 
+    LatencyMark(&g_sLatencyTimer, LATENCY_SEND);
+
     //
     // Get the response status and back it up.
     //
@@ -1123,90 +3570,111 @@ ExositeWrite(HTTPCli_Handle cli)
     {
         return (i32Ret);
     }
+    LatencyMark(&g_sLatencyTimer, LATENCY_FIRST_BYTE);
     ui32Status = (uint32_t)(i32Ret);
 
     //
-    // Flush the remaining headers.  No field headers set using
-    // HTTPCli_setResponseFieldId(), so a call to
-    // HTTPCli_getResponseField() should drop all headers and return
-    // HTTPCli_FIELD_ID_END or HTTPCli_FIELD_ID_DUMMY.
-    //
-    // Date: <date>
-    // Server: <server>
-    // Connection: Close
-    // Content-Length: 0
-    // <blank line>
+    // Read the response headers.  Only the connection management headers are
+    // kept, the rest are dropped.
     //
-    i32Ret = HTTPCli_getResponseField(cli, pcDataBuf, sizeof(pcDataBuf),
-                                      &bMoreFlag);
-    if((i32Ret != HTTPCli_FIELD_ID_END) && (i32Ret != HTTPCli_FIELD_ID_DUMMY))
+    i32Ret = ReadResponseFields(cli, &g_sKeepAlive, NULL, pcDataBuf,
+                                sizeof(pcDataBuf));
+    if(i32Ret < 0)
     {
         return (i32Ret);
     }
 
     //
-    // Did Exosite respond with an undesired status?
+    // Read the response body, counting the calls that succeeded.  This also
+    // cleans up for the next HTTP request if Exosite responded with an
+    // undesired status.
     //
-    if(ui32Status != HTTPStd_NO_CONTENT)
+    ui32Match = 0;
+    ui32CallsOK = 0;
+    do
     {
-        //
-        // Yes - Now extract the Response body into a buffer.  Even though we
-        // don't need this response body, we need to clean up for next HTTP
-        // request.
-        //
-        do
+        i32Ret = HTTPCli_readResponseBody(cli, pcDataBuf, sizeof(pcDataBuf),
+                                          &bMoreFlag);
+        if(i32Ret < 0)
         {
-            i32Ret = HTTPCli_readResponseBody(cli, pcDataBuf,
-                                              sizeof(pcDataBuf), &bMoreFlag);
-            if(i32Ret < 0)
+            return (i32Ret);
+        }
+
+        for(ui32Idx = 0; ui32Idx < (uint32_t)i32Ret; ui32Idx++)
+        {
+            if(pcDataBuf[ui32Idx] != pcCallOK[ui32Match])
             {
-                return (i32Ret);
+                ui32Match = (pcDataBuf[ui32Idx] == pcCallOK[0]) ? 1 : 0;
             }
-            else if(i32Ret)
+            else if(++ui32Match == (sizeof(pcCallOK) - 1))
             {
-                if(i32Ret < sizeof(pcDataBuf))
-                {
-                    pcDataBuf[i32Ret] = '\0';
-                }
+                ui32CallsOK++;
+                ui32Match = 0;
             }
-        } while (bMoreFlag);
+        }
+    } while (bMoreFlag);
 
+    //
+    // Did Exosite respond with an undesired response?
+    //
+    if(ui32Status != HTTPStd_OK)
+    {
         //
-        // Yes - Return the response status.
+        // Yes - Return with the response status.
         //
         return (ui32Status);
     }
 
-    //
-    // Received the desired response status from server.  Hence return 0.
-    //
+    TelemetryRemove(ui32Count);
+    g_sTelemetryStats.ui32Uploads++;
+    if(ui32CallsOK != RECORD_ALIASES)
+    {
+        g_sTelemetryStats.ui32Failed++;
+    }
+
+    LatencyMark(&g_sLatencyTimer, LATENCY_BODY);
     return(0);
 }
 
 //*****************************************************************************
 //
-// Reads (or GETs) data from Exosite.  The following headers are sent by this
-// function.
+// Reads (or GETs) data from Exosite, asking the server to hold the request
+// for up to ui32TimeoutMs until one of the aliases changes.  A timeout of 0
+// reads the current values.  This function is used by the long-poll task on
+// its own connection.  The following headers are sent by this function.
 //
-// GET /onep:v1/stack/alias?ledd1&ledd2&location HTTP/1.1
+// GET /onep:v1/stack/alias?ledd1&location&gamestate&emailaddr HTTP/1.1
 // Host: m2.exosite.com
 // X-Exosite-CIK: <CIK>
 // Accept: application/x-www-form-urlencoded; charset=utf-8
+// Request-Timeout: <timeout>
 //
 //*****************************************************************************
 int32_t
-ExositeRead(HTTPCli_Handle cli)
+ExositeLongPoll(HTTPCli_Handle cli, uint32_t ui32TimeoutMs)
 {
     int32_t i32Ret = 0;
     uint32_t ui32Status = 0;
-    uint32_t ui32BufLen = 0;
     char pcRecBuf[128];
+    char pcFields[160];
+    char pcCIK[EXOSITE_CIK_LENGTH + 1];
+    tSendBuffer sSend;
+    tFormatCursor sCursor;
     bool bMoreFlag;
+    UInt uKey;
+
+    //
+    // Take a copy of the CIK with task switching disabled, as the Cloud task
+    // may change it at any time.
+    //
+    uKey = Task_disable();
+    memcpy(pcCIK, g_pcExositeCIK, sizeof(pcCIK));
+    Task_restore(uKey);
 
     //
     // Make sure that CIK is filled before proceeding.
     //
-    if(g_pcExositeCIK[0] == '\0')
+    if(pcCIK[0] == '\0')
     {
         //
         // CIK is not populated.  Return this error.
@@ -1215,117 +3683,333 @@ ExositeRead(HTTPCli_Handle cli)
     }
 
     //
-    // Copy Exosite URI into a buffer.
+    // Copy Exosite URI and the alias list to watch into a buffer.
     //
-    ui32BufLen = snprintf(pcRecBuf, sizeof(pcRecBuf), EXOSITE_URI);
+    FormatInit(&sCursor, pcRecBuf, sizeof(pcRecBuf));
+    FormatString(&sCursor, EXOSITE_URI);
+    GetAliasList(&sCursor);
 
     //
-    // Get the alias list whose values we need from the cloud server.
+    // Make HTTP 1.1 GET request.
     //
-    GetAliasList((pcRecBuf + ui32BufLen), (sizeof(pcRecBuf) - ui32BufLen));
+    i32Ret = HTTPCli_sendRequest(cli, HTTPStd_GET, pcRecBuf, true);
+    if(i32Ret < 0)
+    {
+        return (i32Ret);
+    }
+
+    SendBufferInit(&sSend, cli);
 
     //
-    // Make HTTP 1.1 GET request.  The following headers are automatically
-    // sent with the GET request.
+    // Send the headers to the send buffer.  The request timeout header
+    // makes this a long-poll.  These are formatted here rather than taken
+    // from the cached header block, which belongs to the Cloud task.
     //
-    // GET /onep:v1/stack/alias?ledd1&location&gamestate&emailaddr HTTP/1.1
-    // Host: m2.exosite.com
+    // X-Exosite-CIK: <CIK>
+    // Accept: application/x-www-form-urlencoded; charset=utf-8
+    // Request-Timeout: <timeout>
+    // <blank line>
     //
-    i32Ret = HTTPCli_sendRequest(cli, HTTPStd_GET, pcRecBuf, true);
+    FormatInit(&sCursor, pcFields, sizeof(pcFields));
+    FormatField(&sCursor, EXOSITE_TYPE, pcCIK);
+    FormatField(&sCursor, HTTPStd_FIELD_NAME_ACCEPT, EXOSITE_CONTENT_TYPE);
+    if(ui32TimeoutMs != 0)
+    {
+        FormatNumberField(&sCursor, EXOSITE_REQUEST_TIMEOUT, ui32TimeoutMs);
+    }
+    FormatBytes(&sCursor, "\r\n", 2);
+    i32Ret = SendBufferWrite(&sSend, pcFields, sCursor.ui32Len);
+    if(i32Ret < 0)
+    {
+        return (i32Ret);
+    }
+
+    //
+    // Write what is left in the send buffer to end the request.
+    //
+    i32Ret = SendBufferFlush(&sSend);
+    if(i32Ret < 0)
+    {
+        return (i32Ret);
+    }
+
+    //
+    // Wait for the server to respond.  This takes up to ui32TimeoutMs if
+    // none of the aliases change.
+    //
+    i32Ret = HTTPCli_getResponseStatus(cli);
+    if(i32Ret < 0)
+    {
+        return (i32Ret);
+    }
+    ui32Status = i32Ret;
+
+    //
+    // Read the response headers.
+    //
+    i32Ret = ReadResponseFields(cli, &g_sLongPollKeepAlive, NULL, pcRecBuf,
+                                sizeof(pcRecBuf));
     if(i32Ret < 0)
     {
         return (i32Ret);
     }
 
     //
-    // Send X-Exosite-CIK header
-    //
-    // X-Exosite-CIK: <CIK>
-    // <blank line>
+    // A 304 means that the request timed out without any of the aliases
+    // changing.
+    //
+    if(ui32Status == HTTPStd_NOT_MODIFIED)
+    {
+        g_sLongPollStats.ui32Timeouts++;
+        return (0);
+    }
+
+    //
+    // Did Exosite respond with an undesired response?
+    //
+    if(ui32Status != HTTPStd_OK)
+    {
+        //
+        // Yes - Flush the response body to clean up for the next HTTP request
+        // and return with the response status.
+        //
+        do
+        {
+            i32Ret = HTTPCli_readResponseBody(cli, pcRecBuf,
+                                              sizeof(pcRecBuf), &bMoreFlag);
+            if(i32Ret < 0)
+            {
+                return (i32Ret);
+            }
+        } while (bMoreFlag);
+
+        return (ui32Status);
+    }
+
+    //
+    // Parse the response body as it is read and perform necessary actions
+    // based on the content.
     //
-    i32Ret = HTTPCli_sendField(cli, EXOSITE_TYPE, g_pcExositeCIK, false);
+    g_ui32LongPollValues = 0;
+    i32Ret = ProcessResponseBody(cli, LongPollAliasValue);
     if(i32Ret < 0)
     {
         return (i32Ret);
     }
 
     //
-    // Send accept header
+    // Only count the response as a change if it carried an alias value.
     //
-    // Accept: <type>
-    // <blank line>
-    //
-    i32Ret = HTTPCli_sendField(cli, HTTPStd_FIELD_NAME_ACCEPT,
-                               EXOSITE_CONTENT_TYPE, true);
-    if(i32Ret < 0)
+    if(g_ui32LongPollValues != 0)
     {
-        return (i32Ret);
+        g_sLongPollStats.ui32Changes++;
     }
 
-    //
-    // Get the response status and back it up.
-    //
-    i32Ret = HTTPCli_getResponseStatus(cli);
-    if(i32Ret < 0)
+    return(0);
+}
+
+//*****************************************************************************
+//
+// This function completes the TLS handshake of the long-poll connection.  It
+// works like TLSHandshake() but offers and keeps the long-poll task's own
+// session, and doesn't update the handshake counters or the session saved in
+// EEPROM, which belong to the Cloud task.
+//
+//*****************************************************************************
+static int32_t
+LongPollHandshake(HTTPCli_Handle cli)
+{
+    WOLFSSL *psSSL;
+
+    psSSL = (WOLFSSL *)cli->ssock.ssl;
+    if(psSSL == NULL)
     {
-        return (i32Ret);
+        return (-1);
     }
-    ui32Status = i32Ret;
 
-    //
-    // Flush the remaining headers.  No field headers set using
-    // HTTPCli_setResponseFieldId(), so a call to
-    // HTTPCli_getResponseField() should drop all headers and return
-    // HTTPCli_FIELD_ID_END or HTTPCli_FIELD_ID_DUMMY.
-    //
-    i32Ret = HTTPCli_getResponseField(cli, pcRecBuf, sizeof(pcRecBuf),
-                                      &bMoreFlag);
-    if((i32Ret != HTTPCli_FIELD_ID_END) && (i32Ret != HTTPCli_FIELD_ID_DUMMY))
+    if(g_psLongPollTLSSession != NULL)
+    {
+        wolfSSL_set_session(psSSL, g_psLongPollTLSSession);
+    }
+
+    if(wolfSSL_connect(psSSL) != SSL_SUCCESS)
+    {
+        g_psLongPollTLSSession = NULL;
+        return (-1);
+    }
+
+    g_psLongPollTLSSession = wolfSSL_get_session(psSSL);
+
+    return (0);
+}
+
+//*****************************************************************************
+//
+// Connect the long-poll task's HTTP client instance to the same server, and
+// through the same endpoint, as the Cloud task.  The endpoint is copied with
+// task switching disabled, as the Cloud task may change it at any time.
+//
+//*****************************************************************************
+static int32_t
+LongPollConnect(HTTPCli_Handle cli)
+{
+    tEndpoint sEndpoint;
+    struct sockaddr_in sSockAddr;
+    int32_t i32Ret;
+    UInt uiKey;
+
+    uiKey = Task_disable();
+    sEndpoint = g_psEndpoints[g_ui32Endpoint];
+    Task_restore(uiKey);
+
+    i32Ret = ConnectRace(sEndpoint.pcAddr, sEndpoint.ui32LastAddr,
+                         &sSockAddr, NULL);
+    if(i32Ret != 0)
+    {
+        return (-1);
+    }
+
+    ProxySet(&sEndpoint, &sSockAddr);
+
+    HTTPCli_construct(cli);
+    HTTPCli_setRequestFields(cli, g_psFields);
+    HTTPCli_setResponseFields(cli, g_ppcResponseFields);
+
+    i32Ret = HTTPCli_connect(cli, (struct sockaddr *)&sSockAddr,
+                             HTTPCli_TYPE_TLS, NULL);
+    if(i32Ret == 0)
+    {
+        i32Ret = LongPollHandshake(cli);
+        if(i32Ret != 0)
+        {
+            HTTPCli_disconnect(cli);
+        }
+    }
+    if(i32Ret != 0)
     {
+        HTTPCli_destruct(cli);
         return (i32Ret);
     }
 
-    //
-    // Did Exosite respond with an undesired response?
-    //
-    if(ui32Status != HTTPStd_OK)
+    KeepAliveReset(&g_sLongPollKeepAlive);
+    return (0);
+}
+
+//*****************************************************************************
+//
+// This task holds a long-poll read open on its own connection while the Cloud
+// task is syncing in Sync_LongPoll mode, so that changes made on the server
+// are processed as soon as they are made.  The Cloud task keeps writing on
+// its connection.
+//
+//*****************************************************************************
+void LongPollTask(unsigned int arg0, unsigned int arg1)
+{
+    HTTPCli_Struct cli;
+    tMailboxMsg sDebug;
+    int32_t i32Ret;
+    bool bConnected = false;
+
+    sDebug.ui32Request = Cmd_Prompt_Print;
+
+    while(1)
     {
         //
-        // Yes - Return with the response status.
+        // Drop the connection when it is not needed.
         //
-        return (ui32Status);
-    }
+        if((g_eSyncMode != Sync_LongPoll) || (g_ui32State != Cloud_Sync))
+        {
+            if(bConnected == true)
+            {
+                ServerDisconnect(&cli);
+                bConnected = false;
+            }
+            Task_sleep(1000);
+            continue;
+        }
 
-    //
-    // Extract the Response body into a buffer.
-    //
-    do
-    {
-        i32Ret = HTTPCli_readResponseBody(cli, pcRecBuf, sizeof(pcRecBuf),
-                                          &bMoreFlag);
-        if(i32Ret < 0)
+        //
+        // Replace the connection if the server is about to close it.
+        //
+        if((bConnected == true) &&
+           KeepAliveExpiring(&g_sLongPollKeepAlive, 1))
         {
-            return (i32Ret);
+            ServerDisconnect(&cli);
+            bConnected = false;
         }
-        else if(i32Ret)
+
+        if(bConnected != true)
         {
-            if(i32Ret < sizeof(pcRecBuf))
+            if(LongPollConnect(&cli) != 0)
             {
-                pcRecBuf[i32Ret] = '\0';
+                Task_sleep(BackoffNext(&g_psBackoff[BACKOFF_LONGPOLL]));
+                continue;
             }
+            bConnected = true;
+
+            //
+            // A long-poll only reports changes made after it reaches the
+            // server, so read the current values first.
+            //
+            i32Ret = ExositeLongPoll(&cli, 0);
+        }
+        else
+        {
+            //
+            // Wait for a change.  A new request is sent as soon as the
+            // previous one completes, so changes made in between are only
+            // missed for the duration of one round trip.
+            //
+            i32Ret = ExositeLongPoll(&cli, LONGPOLL_TIMEOUT);
         }
-    } while (bMoreFlag);
 
-    //
-    // Parse the response body and perform necessary actions based on the
-    // content.
-    //
-    ProcessResponseBody(pcRecBuf);
+        if(i32Ret != 0)
+        {
+            //
+            // Report the error, drop the connection and try again after the
+            // long-poll retry delay.
+            //
+            snprintf(sDebug.pcBuf, TX_BUF_SIZE, "LongPollTask: Read failed, "
+                     "ecode: %d. Reconnecting.\n", i32Ret);
+            Mailbox_post(CloudMailbox, &sDebug, BIOS_NO_WAIT);
+            System_printf(sDebug.pcBuf);
+
+            ServerDisconnect(&cli);
+            bConnected = false;
+            Task_sleep(RetryDelay(&g_psBackoff[BACKOFF_LONGPOLL],
+                                  &g_sLongPollKeepAlive));
+        }
+        else
+        {
+            BackoffReset(&g_psBackoff[BACKOFF_LONGPOLL]);
+        }
+    }
+}
 
-    //
-    // Received the desired response status from server.  Hence return 0.
-    //
-    return(0);
+//*****************************************************************************
+//
+// Create the long-poll task.
+//
+//*****************************************************************************
+static int32_t
+LongPollTaskInit(void)
+{
+    Task_Params sLongPollTaskParams;
+    Error_Block sEB;
+
+    Error_init(&sEB);
+
+    Task_Params_init(&sLongPollTaskParams);
+    sLongPollTaskParams.stackSize = STACK_LONGPOLL_TASK;
+    sLongPollTaskParams.priority = PRIORITY_LONGPOLL_TASK;
+    g_psLongPollHandle = Task_create((Task_FuncPtr)LongPollTask,
+                                     &sLongPollTaskParams, &sEB);
+    if(g_psLongPollHandle == NULL)
+    {
+        return -1;
+    }
+
+    return 0;
 }
 
 //*****************************************************************************
@@ -1341,9 +4025,18 @@ void CloudTask(unsigned int arg0, unsigned int arg1)
     HTTPCli_Struct cli;
     WOLFSSL_CTX *ctx;
     tMailboxMsg sCommandRequest;
+    tAliasValueMsg sAliasValue;
     bool bStatus;
     char * pcDebug;
     uint32_t ui32LED2 = Board_LED_OFF;
+    uint32_t ui32SyncTicks;
+    uint32_t ui32Events;
+    uint32_t ui32Requests;
+    uint32_t ui32Upload;
+    uint32_t ui32Count;
+    tRequestBody sBody;
+    bool bWrite;
+    tSyncMode eSyncMode;
 
     g_sDebug.ui32Request = Cmd_Prompt_Print;
     pcDebug = g_sDebug.pcBuf;
@@ -1356,13 +4049,45 @@ void CloudTask(unsigned int arg0, unsigned int arg1)
              ((g_ui32IPAddr >> 16) & 0xFF), ((g_ui32IPAddr >> 24) & 0xFF));
     Mailbox_post(CloudMailbox, &g_sDebug, BIOS_NO_WAIT);
 
+    //
+    // Seed the retry jitter with values that differ between boards, so that
+    // boards that lose the server at the same time don't retry in step.
+    //
+    BackoffSeed(DeviceHash() ^ g_ui32IPAddr ^ Clock_getTicks());
+
+    //
+    // Pick the offset of this board's syncs into the sync period, and wait a
+    // delay spread over the startup window before the first NTP sync and
+    // connect.  The MAC hash gives each board its own slot, the random part
+    // breaks ties.
+    //
+    ui32Count = (DeviceHash() + BackoffRandom()) % STARTUP_SPREAD;
+    snprintf(pcDebug, TX_BUF_SIZE, "Sync phase %d ms, first connect in %d "
+             "ms.\n", (DeviceHash() % SYNC_PERIOD), ui32Count);
+    Mailbox_post(CloudMailbox, &g_sDebug, BIOS_NO_WAIT);
+    CloudWait(ui32Count);
+
     //
     // Synchronize system time with an NTP server.  Current time is needed to
-    // verify server's SSL certificate.
-    do
+    // verify server's SSL certificate.  A command or a new IP address ends
+    // the wait between attempts early.
+    //
+    while(SyncNTPServer() != 0)
+    {
+        CloudWait(BackoffNext(&g_psBackoff[BACKOFF_CONNECT]));
+    }
+    BackoffReset(&g_psBackoff[BACKOFF_CONNECT]);
+
+    //
+    // Create the sensor sampler now that the samples can be timestamped.
+    //
+    if(TelemetryInit() != 0)
     {
-        i32Ret = SyncNTPServer();
-    }while(i32Ret != 0);
+        snprintf(pcDebug, TX_BUF_SIZE, "CloudTask: Failed to create the "
+                 "telemetry sampler.\n");
+        Mailbox_post(CloudMailbox, &g_sDebug, BIOS_NO_WAIT);
+        System_printf(pcDebug);
+    }
 
     //
     // Setup the WolfSSL parameters
@@ -1418,25 +4143,75 @@ void CloudTask(unsigned int arg0, unsigned int arg1)
         BIOS_exit(1);
     }
 
+#ifdef PERSIST_TLS_SESSION
+    //
+    // Request session tickets from the server and keep sessions valid for as
+    // long as they are kept in EEPROM.
+    //
+    wolfSSL_CTX_UseSessionTicket(ctx);
+    wolfSSL_CTX_set_timeout(ctx, TLS_SESSION_LIFETIME);
+#endif
+
     //
     // Set-up the secure communication parameters.
     //
     SSWolfssl_setContext(ctx);
 
+    //
+    // Try to resume the session from before the last reboot on the first
+    // connect.  A full handshake is done if there is none or the server
+    // refuses it.
+    //
+    LoadTLSSession();
+
+    //
+    // Start the latency histograms of the connect and request phases.
+    //
+    LatencyInit();
+
     //
     // Set state machine flag to try connecting to the cloud server.
     //
     g_ui32State = Cloud_Server_Connect;
+    ui32Events = 0;
 
     while (1)
     {
+        //
+        // A new IP address means that the network is back and that sockets
+        // opened on the old address are gone.  Reconnect right away instead
+        // of at the end of the retry delay.
+        //
+        if(ui32Events & CLOUD_EVENT_NETWORK)
+        {
+            BackoffReset(&g_psBackoff[BACKOFF_CONNECT]);
+            g_ui32RetryTicks = Clock_getTicks();
+            if(g_ui32State == Cloud_Sync)
+            {
+                g_ui32State = Cloud_Server_Connect;
+            }
+        }
+
         //
         // Check if we received any notification from the Command task.
         //
         bStatus = Mailbox_pend(CmdMailbox, &sCommandRequest, BIOS_NO_WAIT);
         if(bStatus)
         {
+            //
+            // A user command is acted on right away, even while waiting to
+            // retry.
+            //
             g_ui32State = (tCloudState) (sCommandRequest.ui32Request);
+            g_ui32RetryTicks = Clock_getTicks();
+        }
+
+        //
+        // Apply the alias values read by the long-poll task.
+        //
+        while(Mailbox_pend(LongPollMailbox, &sAliasValue, BIOS_NO_WAIT))
+        {
+            ApplyAliasValue(sAliasValue.ui32Alias, sAliasValue.pcValue);
         }
 
         //
@@ -1444,6 +4219,18 @@ void CloudTask(unsigned int arg0, unsigned int arg1)
         //
         UpdateCloudData();
 
+        //
+        // Don't try to reach the server until the retry delay set after the
+        // last failure is over.  Keep the samples safe in the meantime, the
+        // sampler wakes the task before the RAM buffer fills up.
+        //
+        if(CloudRetryRemaining() != 0)
+        {
+            TelemetrySpill();
+            ui32Events = CloudWait(CloudRetryRemaining());
+            continue;
+        }
+
         switch(g_ui32State)
         {
             case Cloud_Server_Connect:
@@ -1464,10 +4251,14 @@ void CloudTask(unsigned int arg0, unsigned int arg1)
                 if(ServerConnect(&cli) != 0)
                 {
                     //
-                    // Unsuccesfull in connecting to the server.  Jump to Idle
-                    // state and wait for user command.
+                    // Unsuccesfull in connecting to the server.  Try again
+                    // once the connect retry delay is over.
                     //
-                    g_ui32State = Cloud_Idle;
+                    snprintf(pcDebug, TX_BUF_SIZE, "Retrying in %d ms.\n",
+                             CloudRetryAfter(
+                                 &g_psBackoff[BACKOFF_CONNECT]));
+                    Mailbox_post(CloudMailbox, &g_sDebug, BIOS_NO_WAIT);
+                    System_printf(pcDebug);
                 }
                 else
                 {
@@ -1476,6 +4267,7 @@ void CloudTask(unsigned int arg0, unsigned int arg1)
                     // to cloud server.
                     //
                     g_bServerConnect = true;
+                    BackoffReset(&g_psBackoff[BACKOFF_CONNECT]);
 
                     //
                     // See if a valid CIK exists in NVM.
@@ -1515,9 +4307,21 @@ void CloudTask(unsigned int arg0, unsigned int arg1)
                 //
                 // We don't have a valid CIK.  We would have tried to connect
                 // to server with an invalid CIK, so reconnect to the server
-                // before trying to request a new CIK.
+                // before trying to request a new CIK.  If that fails, start
+                // over with a new connection once the connect retry delay is
+                // over.
                 //
-                ServerReconnect(&cli);
+                if(ServerReconnect(&cli) != 0)
+                {
+                    g_bServerConnect = false;
+                    g_ui32State = Cloud_Server_Connect;
+                    snprintf(pcDebug, TX_BUF_SIZE, "Retrying in %d ms.\n",
+                             CloudRetryAfter(
+                                 &g_psBackoff[BACKOFF_CONNECT]));
+                    Mailbox_post(CloudMailbox, &g_sDebug, BIOS_NO_WAIT);
+                    System_printf(pcDebug);
+                    break;
+                }
 
                 //
                 // Request a new CIK.
@@ -1528,6 +4332,7 @@ void CloudTask(unsigned int arg0, unsigned int arg1)
                     //
                     // We acquired new CIK so communicate with the server.
                     //
+                    BackoffReset(&g_psBackoff[BACKOFF_SERVER]);
                     g_ui32State = Cloud_Sync;
                 }
 
@@ -1537,26 +4342,157 @@ void CloudTask(unsigned int arg0, unsigned int arg1)
             case Cloud_Sync:
             {
                 //
-                // Gather and send relevant data to Exosite server.
+                // If the server is about to close the connection, replace it
+                // now rather than have the next request fail.
+                //
+                eSyncMode = g_eSyncMode;
+                if((eSyncMode == Sync_Separate) ||
+                   (eSyncMode == Sync_Pipelined))
+                {
+                    ui32Requests = 2;
+                }
+                else
+                {
+                    ui32Requests = 1;
+                }
+                if(TelemetryUploadSize() != 0)
+                {
+                    ui32Requests += ((TelemetryOutboxCount() != 0) ?
+                                     TELEMETRY_DRAIN_BATCHES : 1);
+                }
+                if(KeepAliveExpiring(&g_sKeepAlive, ui32Requests))
+                {
+                    if(ServerReconnect(&cli) != 0)
+                    {
+                        g_bServerConnect = false;
+                        g_ui32State = Cloud_Server_Connect;
+                        break;
+                    }
+                }
+
+                //
+                // Start the long-poll task the first time it is needed.
+                //
+                if((eSyncMode == Sync_LongPoll) &&
+                   (g_psLongPollHandle == NULL))
+                {
+                    if(LongPollTaskInit() != 0)
+                    {
+                        snprintf(pcDebug, TX_BUF_SIZE, "CloudTask: Failed to "
+                                 "create LongPollTask.\n");
+                        Mailbox_post(CloudMailbox, &g_sDebug, BIOS_NO_WAIT);
+                        System_printf(pcDebug);
+
+                        g_eSyncMode = Sync_Combined;
+                        eSyncMode = Sync_Combined;
+                    }
+                }
+
+                ui32SyncTicks = Clock_getTicks();
+
+                //
+                // Gather the data to send.  This must be done before any
+                // read request is built as it updates the read/write mode of
+                // the aliases that are written.  The write is skipped if none
+                // of the aliases changed.
                 //
-                i32Ret = ExositeWrite(&cli);
+                GetRequestBody(&sBody);
+                bWrite = (sBody.ui32Dirty != 0);
+                if(!bWrite)
+                {
+                    g_ui32WritesSkipped++;
+                }
+
+                switch(eSyncMode)
+                {
+                    case Sync_Separate:
+                    {
+                        //
+                        // Send relevant data to Exosite server, then read
+                        // data from Exosite server and process it.
+                        //
+                        i32Ret = bWrite ? ExositeWrite(&cli, &sBody) : 0;
+                        if(i32Ret == 0)
+                        {
+                            i32Ret = ExositeRead(&cli);
+                        }
+                        break;
+                    }
+
+                    case Sync_Pipelined:
+                    {
+                        //
+                        // Same as above, but without waiting for the response
+                        // to the write before sending the read.
+                        //
+                        i32Ret = bWrite ? ExositePipelined(&cli, &sBody) :
+                                 ExositeRead(&cli);
+                        break;
+                    }
+
+                    case Sync_LongPoll:
+                    {
+                        //
+                        // Only send data.  The long-poll task reads.
+                        //
+                        i32Ret = bWrite ? ExositeWrite(&cli, &sBody) : 0;
+                        break;
+                    }
+
+                    case Sync_Combined:
+                    default:
+                    {
+                        //
+                        // Send relevant data to and read data from Exosite
+                        // server in a single request.
+                        //
+                        i32Ret = bWrite ? ExositeSync(&cli, &sBody) :
+                                 ExositeRead(&cli);
+                        break;
+                    }
+                }
                 if(i32Ret != 0)
                 {
                     //
-                    // We got an error, so break to handle error.
+                    // We got an error, so break to handle error.  The data
+                    // may not have reached the server, so write all of it
+                    // with the next request.
                     //
+                    g_bFullRefresh = true;
                     break;
                 }
 
                 //
-                // Read data from Exosite server and process it.
+                // Record the time taken by this cycle.
                 //
-                i32Ret = ExositeRead(&cli);
+                ui32SyncTicks = ((Clock_getTicks() - ui32SyncTicks) * 1000 /
+                                 BIOS_TICK_RATE);
+                g_psSyncStats[eSyncMode].ui32Cycles++;
+                g_psSyncStats[eSyncMode].ui32TotalMs += ui32SyncTicks;
+                g_psSyncStats[eSyncMode].ui32LastMs = ui32SyncTicks;
+
+                //
+                // Upload the sensor samples once a full batch is buffered.
+                // Samples left in the outbox are drained a few batches per
+                // cycle, so the sync itself is not held up.  Samples are
+                // only removed once the server acknowledged them.
+                //
+                for(ui32Upload = 0; ui32Upload < TELEMETRY_DRAIN_BATCHES;
+                    ui32Upload++)
+                {
+                    ui32Count = TelemetryUploadSize();
+                    if(ui32Count == 0)
+                    {
+                        break;
+                    }
+                    i32Ret = ExositeRecord(&cli, ui32Count);
+                    if(i32Ret != 0)
+                    {
+                        break;
+                    }
+                }
                 if(i32Ret != 0)
                 {
-                    //
-                    // We got an error, so break to handle error.
-                    //
                     break;
                 }
 
@@ -1571,6 +4507,7 @@ void CloudTask(unsigned int arg0, unsigned int arg1)
                 // We were successful in communicating with cloud server.
                 // Continue to do this.
                 //
+                BackoffReset(&g_psBackoff[BACKOFF_SERVER]);
                 g_ui32State = Cloud_Sync;
                 break;
             }
@@ -1615,6 +4552,15 @@ void CloudTask(unsigned int arg0, unsigned int arg1)
             }
         }
 
+        //
+        // While the samples can't be uploaded, move them from RAM to the
+        // outbox in EEPROM so they are not lost.
+        //
+        if((g_ui32State != Cloud_Sync) || (i32Ret != 0))
+        {
+            TelemetrySpill();
+        }
+
         //
         // Check if we got a -ve error.
         //
@@ -1645,6 +4591,12 @@ void CloudTask(unsigned int arg0, unsigned int arg1)
             Mailbox_post(CloudMailbox, &g_sDebug, BIOS_NO_WAIT);
             System_printf(pcDebug);
 
+            //
+            // Count the error against the endpoint of the connection.
+            //
+            EndpointFailure(&g_psEndpoints[g_ui32Endpoint], Clock_getTicks(),
+                            (ENDPOINT_HOLD_MS * BIOS_TICK_RATE) / 1000);
+
             //
             // Set state variable to reconnect to cloud server.
             //
@@ -1660,9 +4612,18 @@ void CloudTask(unsigned int arg0, unsigned int arg1)
         }
 
         //
-        // Wait a second before communciating with Exosite server again.
+        // Resolve the host names whose cached addresses expired while the
+        // connection isn't waiting for it.
+        //
+        DNSCacheRefresh();
+
+        //
+        // Wait for the next sync slot before communicating with the Exosite
+        // server again.  A command, a local change to the board data, a new
+        // IP address or a filling sample buffer is handled without waiting
+        // for the slot.
         //
-        Task_sleep(1000);
+        ui32Events = SyncWait();
     }
 }
 
@@ -1677,6 +4638,16 @@ int32_t CloudTaskInit()
     Task_Params sCloudTaskParams;
     Error_Block sEB;
 
+    //
+    // Build the alias lookup table before any response is processed.
+    //
+    if(AliasTableInit() != 0)
+    {
+        System_printf("CloudTaskInit: Alias hash collision or bad sync "
+                      "bit.\n");
+        return -1;
+    }
+
     Error_init(&sEB);
 
     Task_Params_init(&sCloudTaskParams);
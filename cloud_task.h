@@ -45,6 +45,23 @@
 #define NTP_SERVER_URL          "time.nist.gov"
 #define NTP_SERVER_PORT         123
 
+//*****************************************************************************
+//
+// ToDo USER STEP:
+// Uncomment the label "PERSIST_TLS_SESSION" to save the last TLS session in
+// EEPROM, so that the first connection after a reboot can be resumed instead
+// of doing a full handshake.  This needs the WolfSSL library to be built with
+// HAVE_SESSION_TICKET and HAVE_EXT_CACHE defined, which the default TI-RTOS
+// build of WolfSSL doesn't do.  The saved session includes its master secret
+// and is stored in EEPROM unencrypted, so anyone who can read the EEPROM of
+// the board can decrypt the traffic of that session.  The label
+// "TLS_SESSION_LIFETIME" defines, in seconds, how long a saved session is
+// offered to the server.
+//
+//*****************************************************************************
+//#define PERSIST_TLS_SESSION
+#define TLS_SESSION_LIFETIME    3600
+
 //*****************************************************************************
 //
 // Exosite Server IP address and Port number.
@@ -52,6 +69,27 @@
 //*****************************************************************************
 #define EXOSITE_ADDR            "m2.exosite.com:443"
 
+//*****************************************************************************
+//
+// ToDo USER STEP:
+// Define the "<host>:<port>" of an alternate server that the board connects
+// to when neither the direct route nor the proxy work, using the label
+// "EXOSITE_ALT_ADDR".  Leave it empty if there is none.
+//
+//*****************************************************************************
+#define EXOSITE_ALT_ADDR        ""
+
+//*****************************************************************************
+//
+// Routes to the server, by index in g_psEndpoints, in order of preference
+// when their health scores are equal.
+//
+//*****************************************************************************
+#define ENDPOINT_DIRECT         0
+#define ENDPOINT_PROXY          1
+#define ENDPOINT_ALTERNATE      2
+#define NUM_ENDPOINTS           3
+
 //*****************************************************************************
 //
 // Labels that define size of the MAC Address.
@@ -68,15 +106,6 @@
 #define EXOSITE_LENGTH          65
 #define EXOSITE_CIK_LENGTH      40
 
-//*****************************************************************************
-//
-// Labels that define the number of Alias that will be received from the server
-// and size of the value returned.
-//
-//*****************************************************************************
-#define ALIAS_PROCESSING        3
-#define VALUEBUF_SIZE           40
-
 //*****************************************************************************
 //
 // Cloud connection states.
@@ -91,6 +120,60 @@ typedef enum
     Cloud_Idle
 } tCloudState;
 
+//*****************************************************************************
+//
+// Ways of exchanging data with the cloud server in the Cloud_Sync state.
+// Sync_Combined writes and reads the aliases with a single POST request.
+// Sync_Separate uses a POST request to write followed by a GET request to
+// read.  Sync_Pipelined sends the same two requests back-to-back before
+// reading either response.  Sync_LongPoll only writes from the Cloud task,
+// while a separate task holds a read open on a second connection until the
+// server reports a change to one of the aliases.
+//
+//*****************************************************************************
+typedef enum
+{
+    Sync_Combined,
+    Sync_Separate,
+    Sync_Pipelined,
+    Sync_LongPoll
+} tSyncMode;
+
+#define NUM_SYNC_MODES          4
+
+//*****************************************************************************
+//
+// Time in milliseconds that the server holds a long-poll read open before
+// responding that no alias has changed.
+//
+//*****************************************************************************
+#define LONGPOLL_TIMEOUT        30000
+
+//*****************************************************************************
+//
+// Wall time of the successful Cloud_Sync cycles of a sync mode, in
+// milliseconds.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32Cycles;
+    uint32_t ui32TotalMs;
+    uint32_t ui32LastMs;
+} tSyncStats;
+
+//*****************************************************************************
+//
+// Long-poll read counters.  A change is a response carrying new alias values,
+// a timeout is a response saying that nothing changed.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32Changes;
+    uint32_t ui32Timeouts;
+} tLongPollStats;
+
 //*****************************************************************************
 //
 // Write/Read status of an alias to/from the cloud server.
@@ -104,9 +187,83 @@ typedef enum
     NONE
 } tReadWriteType;
 
+//*****************************************************************************
+//
+// TLS session resumption counters and handshake timing.  Times are in
+// milliseconds and include the TCP connect.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // Number of handshakes where the server resumed the cached session.
+    //
+    uint32_t ui32Hits;
+
+    //
+    // Number of handshakes that were full handshakes.
+    //
+    uint32_t ui32Misses;
+
+    //
+    // Duration of the last handshake.
+    //
+    uint32_t ui32LastMs;
+
+    //
+    // Total time spent in full and in resumed handshakes.
+    //
+    uint32_t ui32FullMs;
+    uint32_t ui32ResumedMs;
+} tTLSStats;
+
+//*****************************************************************************
+//
+// Retry policies of the Cloud task, by index in g_psBackoff.  Connect is used
+// after a failed connection to the server or NTP sync, Server after the
+// server returned an error status and LongPoll by the long-poll task.
+//
+//*****************************************************************************
+#define BACKOFF_CONNECT         0
+#define BACKOFF_SERVER          1
+#define BACKOFF_LONGPOLL        2
+#define NUM_BACKOFFS            3
+
+//*****************************************************************************
+//
+// Largest cap, in milliseconds, that can be set on a retry policy.
+//
+//*****************************************************************************
+#define BACKOFF_MAX_CAP         3600000
+
+//*****************************************************************************
+//
+// Events that wake the Cloud task, as posted to the CloudEvent object.
+// Command and LongPoll are posted by CmdMailbox and LongPollMailbox when a
+// message is queued and must match their readerEventId in secure_iot.cfg.
+// Update is posted when board data that is synced with the server changes
+// locally, Network when the IP address is acquired again and Telemetry when
+// the sample buffer is half full.
+//
+//*****************************************************************************
+#define CLOUD_EVENT_COMMAND     0x00000001
+#define CLOUD_EVENT_UPDATE      0x00000002
+#define CLOUD_EVENT_NETWORK     0x00000004
+#define CLOUD_EVENT_TELEMETRY   0x00000008
+#define CLOUD_EVENT_LONGPOLL    0x00000010
+#define CLOUD_EVENT_ALL         0x0000001F
+
 extern char g_pcMACAddress[MAC_ADDRESS_LENGTH + 1];
 extern uint32_t g_ui32IPAddr;
 extern bool g_bServerConnect;
+extern tTLSStats g_sTLSStats;
+extern tSyncMode g_eSyncMode;
+extern tSyncStats g_psSyncStats[NUM_SYNC_MODES];
+extern tLongPollStats g_sLongPollStats;
+extern uint32_t g_ui32WritesSkipped;
+extern uint32_t g_ui32ReadsNotModified;
+extern uint32_t g_ui32SyncPeriod;
+extern uint32_t g_ui32SyncMask;
 
 //*****************************************************************************
 //
@@ -115,5 +272,7 @@ extern bool g_bServerConnect;
 //
 //*****************************************************************************
 extern int32_t CloudTaskInit(void);
+extern uint32_t CloudRetryRemaining(void);
+extern void CloudNotify(uint32_t ui32Events);
 
 #endif // __CLOUD_TASK_H__
@@ -25,18 +25,26 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ti/drivers/UART.h>
+#include <ti/net/http/httpcli.h>
 #include <ti/net/network.h>
 #include <ti/sysbios/BIOS.h>
+#include <ti/sysbios/knl/Clock.h>
 #include <ti/sysbios/knl/Task.h>
 #include <xdc/cfg/global.h>
 #include <xdc/runtime/System.h>
 #include "Board.h"
 #include "UARTUtils.h"
+#include "backoff.h"
 #include "board_funcs.h"
 #include "command_task.h"
 #include "cloud_task.h"
+#include "dns_cache.h"
+#include "endpoint.h"
+#include "latency.h"
 #include "ntp_time.h"
 #include "priorities.h"
+#include "send_buffer.h"
+#include "telemetry.h"
 #include "tictactoe.h"
 
 //*****************************************************************************
@@ -104,6 +112,12 @@ extern tReadWriteType g_eEmailRW;
 extern char g_pcAlert[50];
 extern tReadWriteType g_eAlertRW;
 
+extern tBackoff g_psBackoff[NUM_BACKOFFS];
+extern tEndpoint g_psEndpoints[NUM_ENDPOINTS];
+
+extern char g_pcLatencies[100];
+extern tReadWriteType g_eLatenciesRW;
+
 //*****************************************************************************
 //
 // This function implements the "help" command.  It prints a simple list of the
@@ -231,6 +245,11 @@ Cmd_led(int argc, char *argv[])
             g_ui32LEDD1 = (argv[1][1] == 'n') ? 1 : 0;
             g_eLEDD1RW = READ_WRITE;
 
+            //
+            // Have the Cloud task apply and send the change now.
+            //
+            CloudNotify(CLOUD_EVENT_UPDATE);
+
             return 0;
         }
     }
@@ -397,10 +416,11 @@ Cmd_setemail(int argc, char *argv[])
     g_pcEmail[99] = 0;
 
     //
-    // Mark the location as READ_WRITE, so it will get uploaded to the
-    // server on the next sync.
+    // Mark the location as READ_WRITE, and wake the Cloud task so it gets
+    // uploaded to the server right away.
     //
     g_eEmailRW = READ_WRITE;
+    CloudNotify(CLOUD_EVENT_UPDATE);
 
     ui32BufLen = snprintf(g_pcTXBuf, TX_BUF_SIZE,"Email set to: %s\n\n",
                           g_pcEmail);
@@ -452,6 +472,7 @@ Cmd_alert(int argc, char *argv[])
     ui32Index = strtoul(argv[1], NULL, 0);
     strncpy(g_pcAlert, g_ppcAlertMessages[ui32Index], sizeof(g_pcAlert));
     g_eAlertRW = READ_WRITE;
+    CloudNotify(CLOUD_EVENT_UPDATE);
 
     ui32BufLen = snprintf(g_pcTXBuf, TX_BUF_SIZE,"Alert message set. Sending "
                           "to the server on the next sync operation.\n");
@@ -549,6 +570,458 @@ Cmd_ntp(int argc, char *argv[])
     return 0;
 }
 
+//*****************************************************************************
+//
+// The syncmode command selects whether data is written to and read from the
+// cloud server with a single request, with two separate requests or with two
+// pipelined requests.  Without an argument it prints the average time taken
+// by a sync cycle in each mode.
+//
+//*****************************************************************************
+int
+Cmd_syncmode(int argc, char *argv[])
+{
+    static const char * const ppcModes[NUM_SYNC_MODES] =
+    {
+        "single",
+        "split",
+        "pipelined",
+        "longpoll"
+    };
+    uint32_t ui32BufLen;
+    uint32_t ui32Idx;
+
+    if(argc == 2)
+    {
+        for(ui32Idx = 0; ui32Idx < NUM_SYNC_MODES; ui32Idx++)
+        {
+            if(strcmp(argv[1], ppcModes[ui32Idx]) == 0)
+            {
+                g_eSyncMode = (tSyncMode)ui32Idx;
+                return 0;
+            }
+        }
+    }
+
+    //
+    // The required arguments were not passed.  So print this command's help
+    // along with the timing of each mode.
+    //
+    ui32BufLen = snprintf(g_pcTXBuf, TX_BUF_SIZE,"\nsyncmode command usage:"
+                          "\n\n    syncmode <single|split|pipelined|"
+                          "longpoll>\n\n    Current mode: %s\n",
+                          ppcModes[g_eSyncMode]);
+    UART_write(g_psUARTHandle, g_pcTXBuf, ui32BufLen);
+
+    for(ui32Idx = 0; ui32Idx < NUM_SYNC_MODES; ui32Idx++)
+    {
+        ui32BufLen = snprintf(g_pcTXBuf, TX_BUF_SIZE, "    %-9s: %d cycles, "
+                              "avg %d ms, last %d ms\n", ppcModes[ui32Idx],
+                              g_psSyncStats[ui32Idx].ui32Cycles,
+                              (g_psSyncStats[ui32Idx].ui32Cycles ?
+                               (g_psSyncStats[ui32Idx].ui32TotalMs /
+                                g_psSyncStats[ui32Idx].ui32Cycles) : 0),
+                              g_psSyncStats[ui32Idx].ui32LastMs);
+        UART_write(g_psUARTHandle, g_pcTXBuf, ui32BufLen);
+    }
+
+    ui32BufLen = snprintf(g_pcTXBuf, TX_BUF_SIZE, "    Long-poll changes: %d,"
+                          " timeouts: %d\n    Writes skipped, no change: "
+                          "%d\n", g_sLongPollStats.ui32Changes,
+                          g_sLongPollStats.ui32Timeouts, g_ui32WritesSkipped);
+    UART_write(g_psUARTHandle, g_pcTXBuf, ui32BufLen);
+
+    ui32BufLen = snprintf(g_pcTXBuf, TX_BUF_SIZE,
+                          "    Reads not modified: %d\n",
+                          g_ui32ReadsNotModified);
+    UART_write(g_psUARTHandle, g_pcTXBuf, ui32BufLen);
+
+    ui32BufLen = snprintf(g_pcTXBuf, TX_BUF_SIZE,
+                          "    Server sync period: %d ms, mask: 0x%08x\n",
+                          g_ui32SyncPeriod, g_ui32SyncMask);
+    UART_write(g_psUARTHandle, g_pcTXBuf, ui32BufLen);
+
+    return 0;
+}
+
+//*****************************************************************************
+//
+// The tlsstats command prints the TLS session resumption counters and the
+// average handshake time for full and resumed handshakes.
+//
+//*****************************************************************************
+int
+Cmd_tlsstats(int argc, char *argv[])
+{
+    uint32_t ui32BufLen;
+
+    ui32BufLen = snprintf(g_pcTXBuf, TX_BUF_SIZE, "TLS resumption hits: %d, "
+                          "misses: %d, last handshake: %d ms\n",
+                          g_sTLSStats.ui32Hits, g_sTLSStats.ui32Misses,
+                          g_sTLSStats.ui32LastMs);
+    UART_write(g_psUARTHandle, g_pcTXBuf, ui32BufLen);
+
+    ui32BufLen = snprintf(g_pcTXBuf, TX_BUF_SIZE, "    Average full: %d ms, "
+                          "resumed: %d ms\n",
+                          (g_sTLSStats.ui32Misses ?
+                           (g_sTLSStats.ui32FullMs / g_sTLSStats.ui32Misses) :
+                           0),
+                          (g_sTLSStats.ui32Hits ?
+                           (g_sTLSStats.ui32ResumedMs / g_sTLSStats.ui32Hits) :
+                           0));
+    UART_write(g_psUARTHandle, g_pcTXBuf, ui32BufLen);
+
+    return 0;
+}
+
+//*****************************************************************************
+//
+// The sendbuf command selects whether request writes are collected into
+// larger TLS records or written as they are made.  Without an argument it
+// prints the number and average size of the records written for the header
+// fields and bodies of requests, after the request line and Host field.
+//
+//*****************************************************************************
+int
+Cmd_sendbuf(int argc, char *argv[])
+{
+    uint32_t ui32BufLen;
+
+    if(argc == 2)
+    {
+        if(strcmp(argv[1], "on") == 0)
+        {
+            g_bSendBuffered = true;
+            return 0;
+        }
+        else if(strcmp(argv[1], "off") == 0)
+        {
+            g_bSendBuffered = false;
+            return 0;
+        }
+        else if(strcmp(argv[1], "reset") == 0)
+        {
+            g_sSendBufferStats.ui32BodyRecords = 0;
+            g_sSendBufferStats.ui32BodyBytes = 0;
+            return 0;
+        }
+    }
+
+    //
+    // The required arguments were not passed.  So print this command's help
+    // along with the record counters.
+    //
+    ui32BufLen = snprintf(g_pcTXBuf, TX_BUF_SIZE,"\nsendbuf command usage:"
+                          "\n\n    sendbuf <on|off|reset>\n\n    Current "
+                          "mode: %s\n", (g_bSendBuffered ? "on" : "off"));
+    UART_write(g_psUARTHandle, g_pcTXBuf, ui32BufLen);
+
+    ui32BufLen = snprintf(g_pcTXBuf, TX_BUF_SIZE, "    Header and body "
+                          "records: %d, bytes: %d, average record: %d "
+                          "bytes\n", g_sSendBufferStats.ui32BodyRecords,
+                          g_sSendBufferStats.ui32BodyBytes,
+                          (g_sSendBufferStats.ui32BodyRecords ?
+                           (g_sSendBufferStats.ui32BodyBytes /
+                            g_sSendBufferStats.ui32BodyRecords) : 0));
+    UART_write(g_psUARTHandle, g_pcTXBuf, ui32BufLen);
+
+    return 0;
+}
+
+//*****************************************************************************
+//
+// The telemetry command sets how often the sensors are sampled and how many
+// samples are uploaded per request.  Without arguments it prints the current
+// settings along with the sampler and upload counters.
+//
+//*****************************************************************************
+int
+Cmd_telemetry(int argc, char *argv[])
+{
+    uint32_t ui32BufLen;
+    uint32_t ui32Period;
+
+    if(argc == 3)
+    {
+        ui32Period = strtoul(argv[1], NULL, 0);
+        if(ui32Period != 0)
+        {
+            TelemetryConfig(ui32Period, strtoul(argv[2], NULL, 0));
+            return 0;
+        }
+    }
+
+    //
+    // The required arguments were not passed.  So print this command's help
+    // along with the counters.
+    //
+    ui32BufLen = snprintf(g_pcTXBuf, TX_BUF_SIZE,"\ntelemetry command usage:"
+                          "\n\n    telemetry <period ms> <samples per upload"
+                          ">\n\n    0 samples per upload disables the "
+                          "sampler.\n");
+    UART_write(g_psUARTHandle, g_pcTXBuf, ui32BufLen);
+
+    ui32BufLen = snprintf(g_pcTXBuf, TX_BUF_SIZE, "\n    Current: every %d "
+                          "ms, %d per upload\n", TelemetryPeriod(),
+                          TelemetryBatch());
+    UART_write(g_psUARTHandle, g_pcTXBuf, ui32BufLen);
+
+    ui32BufLen = snprintf(g_pcTXBuf, TX_BUF_SIZE, "    Samples: %d, dropped: "
+                          "%d, buffered: %d\n    Uploads: %d, rejected: %d\n",
+                          g_sTelemetryStats.ui32Samples,
+                          g_sTelemetryStats.ui32Dropped, TelemetryCount(),
+                          g_sTelemetryStats.ui32Uploads,
+                          g_sTelemetryStats.ui32Failed);
+    UART_write(g_psUARTHandle, g_pcTXBuf, ui32BufLen);
+
+    return 0;
+}
+
+//*****************************************************************************
+//
+// The outbox command prints how many samples are waiting to be uploaded, in
+// RAM and in the EEPROM outbox, how old the oldest one is and how fast the
+// outbox drains once the server can be reached again.
+//
+//*****************************************************************************
+int
+Cmd_outbox(int argc, char *argv[])
+{
+    uint32_t ui32BufLen;
+    uint32_t ui32Outbox;
+
+    ui32Outbox = TelemetryOutboxCount();
+    ui32BufLen = snprintf(g_pcTXBuf, TX_BUF_SIZE, "\nOutbox: %d queued, %d in"
+                          " RAM, %d of %d in EEPROM\n",
+                          TelemetryCount(), (TelemetryCount() - ui32Outbox),
+                          ui32Outbox, OUTBOX_RECORDS);
+    UART_write(g_psUARTHandle, g_pcTXBuf, ui32BufLen);
+
+    ui32BufLen = snprintf(g_pcTXBuf, TX_BUF_SIZE, "    Oldest: %d s, drain "
+                          "rate: %d samples/s\n", TelemetryOldestAge(),
+                          g_sTelemetryStats.ui32DrainRate);
+    UART_write(g_psUARTHandle, g_pcTXBuf, ui32BufLen);
+
+    ui32BufLen = snprintf(g_pcTXBuf, TX_BUF_SIZE, "    Spilled: %d, drained: "
+                          "%d, lost when full: %d\n",
+                          g_sTelemetryStats.ui32Spilled,
+                          g_sTelemetryStats.ui32Drained,
+                          g_sTelemetryStats.ui32Lost);
+    UART_write(g_psUARTHandle, g_pcTXBuf, ui32BufLen);
+
+    return 0;
+}
+
+//*****************************************************************************
+//
+// The backoff command sets the base delay and the cap of the retry policies
+// used when the server can't be reached.  Without arguments it prints the
+// state of each policy.
+//
+//*****************************************************************************
+int
+Cmd_backoff(int argc, char *argv[])
+{
+    uint32_t ui32BufLen;
+    uint32_t ui32Idx;
+    uint32_t ui32Base, ui32Cap;
+
+    if(argc == 3)
+    {
+        ui32Base = strtoul(argv[1], NULL, 0);
+        ui32Cap = strtoul(argv[2], NULL, 0);
+        if((ui32Base != 0) && (ui32Cap <= BACKOFF_MAX_CAP))
+        {
+            for(ui32Idx = 0; ui32Idx < NUM_BACKOFFS; ui32Idx++)
+            {
+                BackoffConfig(&g_psBackoff[ui32Idx], ui32Base, ui32Cap);
+            }
+            return 0;
+        }
+    }
+
+    //
+    // The required arguments were not passed.  So print this command's help
+    // along with the state of the policies.
+    //
+    ui32BufLen = snprintf(g_pcTXBuf, TX_BUF_SIZE, "\nbackoff command usage:"
+                          "\n\n    backoff <base ms> <cap ms>\n\n    Sets "
+                          "all retry policies.\n");
+    UART_write(g_psUARTHandle, g_pcTXBuf, ui32BufLen);
+
+    for(ui32Idx = 0; ui32Idx < NUM_BACKOFFS; ui32Idx++)
+    {
+        ui32BufLen = snprintf(g_pcTXBuf, TX_BUF_SIZE, "\n    %-8s base %d ms,"
+                              " cap %d ms, failures %d, last delay %d ms",
+                              g_psBackoff[ui32Idx].pcName,
+                              g_psBackoff[ui32Idx].ui32BaseMs,
+                              g_psBackoff[ui32Idx].ui32CapMs,
+                              g_psBackoff[ui32Idx].ui32Failures,
+                              g_psBackoff[ui32Idx].ui32LastMs);
+        UART_write(g_psUARTHandle, g_pcTXBuf, ui32BufLen);
+    }
+
+    ui32BufLen = snprintf(g_pcTXBuf, TX_BUF_SIZE, "\n    Next retry in %d "
+                          "ms\n", CloudRetryRemaining());
+    UART_write(g_psUARTHandle, g_pcTXBuf, ui32BufLen);
+
+    return 0;
+}
+
+//*****************************************************************************
+//
+// The endpoints command prints the routes to the server with their health.
+// The score is the expected connect time in milliseconds, including a penalty
+// for the recent errors.  Lower is better.
+//
+//*****************************************************************************
+int
+Cmd_endpoints(int argc, char *argv[])
+{
+    uint32_t ui32BufLen;
+    uint32_t ui32Idx;
+    tEndpoint *psEndpoint;
+
+    for(ui32Idx = 0; ui32Idx < NUM_ENDPOINTS; ui32Idx++)
+    {
+        psEndpoint = &g_psEndpoints[ui32Idx];
+        ui32BufLen = snprintf(g_pcTXBuf, TX_BUF_SIZE, "\n%-9s %s%s\n",
+                              psEndpoint->pcName,
+                              (psEndpoint->pcAddr[0] ? psEndpoint->pcAddr :
+                               "(not configured)"),
+                              (psEndpoint->bProxy ? " (proxy)" : ""));
+        UART_write(g_psUARTHandle, g_pcTXBuf, ui32BufLen);
+
+        ui32BufLen = snprintf(g_pcTXBuf, TX_BUF_SIZE, "    Score: %d, "
+                              "connect: %d ms, error rate: %d%%\n",
+                              EndpointScore(psEndpoint),
+                              psEndpoint->ui32LatencyMs,
+                              ((psEndpoint->ui32ErrorRate * 100) /
+                               ENDPOINT_RATE_ONE));
+        UART_write(g_psUARTHandle, g_pcTXBuf, ui32BufLen);
+
+        ui32BufLen = snprintf(g_pcTXBuf, TX_BUF_SIZE, "    Connects: %d, "
+                              "errors: %d, failures in a row: %d%s\n",
+                              psEndpoint->ui32Connects,
+                              psEndpoint->ui32Errors,
+                              psEndpoint->ui32Failures,
+                              (EndpointHealthy(psEndpoint, Clock_getTicks()) ?
+                               "" : ", demoted"));
+        UART_write(g_psUARTHandle, g_pcTXBuf, ui32BufLen);
+    }
+
+    return 0;
+}
+
+//*****************************************************************************
+//
+// The dnscache command prints the DNS cache counters and the cached host
+// names.
+//
+//*****************************************************************************
+int
+Cmd_dnscache(int argc, char *argv[])
+{
+    char pcHost[DNS_CACHE_NAME_SIZE];
+    uint32_t ui32BufLen;
+    uint32_t ui32Idx, ui32Count, ui32Age, ui32Lookups;
+
+    ui32Lookups = (g_sDNSCacheStats.ui32Hits + g_sDNSCacheStats.ui32StaleHits +
+                   g_sDNSCacheStats.ui32Misses);
+    ui32BufLen = snprintf(g_pcTXBuf, TX_BUF_SIZE, "\nDNS cache hits: %d, "
+                          "stale hits: %d, misses: %d (hit rate %d%%)\n",
+                          g_sDNSCacheStats.ui32Hits,
+                          g_sDNSCacheStats.ui32StaleHits,
+                          g_sDNSCacheStats.ui32Misses,
+                          (ui32Lookups ?
+                           (((ui32Lookups - g_sDNSCacheStats.ui32Misses) *
+                             100) / ui32Lookups) : 0));
+    UART_write(g_psUARTHandle, g_pcTXBuf, ui32BufLen);
+
+    ui32BufLen = snprintf(g_pcTXBuf, TX_BUF_SIZE, "    Refreshes: %d, failed "
+                          "lookups: %d\n", g_sDNSCacheStats.ui32Refreshes,
+                          g_sDNSCacheStats.ui32Failures);
+    UART_write(g_psUARTHandle, g_pcTXBuf, ui32BufLen);
+
+    for(ui32Idx = 0; ui32Idx < DNS_CACHE_ENTRIES; ui32Idx++)
+    {
+        ui32Count = DNSCacheEntry(ui32Idx, pcHost, &ui32Age);
+        if(ui32Count != 0)
+        {
+            ui32BufLen = snprintf(g_pcTXBuf, TX_BUF_SIZE, "    %s: %d "
+                                  "address(es), %d s old%s\n", pcHost,
+                                  ui32Count, ui32Age,
+                                  ((ui32Age >= DNS_CACHE_TTL) ? ", stale" :
+                                   ""));
+            UART_write(g_psUARTHandle, g_pcTXBuf, ui32BufLen);
+        }
+    }
+
+    return 0;
+}
+
+//*****************************************************************************
+//
+// The latency command prints the duration of each phase of the connects and
+// requests to the server.  "latency reset" clears them and "latency post on"
+// or "latency post off" turns the posting of their 95th percentile to the
+// "latencies" alias on or off.
+//
+//*****************************************************************************
+int
+Cmd_latency(int argc, char *argv[])
+{
+    uint32_t ui32BufLen;
+    uint32_t ui32Phase;
+    tLatencyHistogram *psHistogram;
+
+    if((argc == 2) && (strcmp(argv[1], "reset") == 0))
+    {
+        LatencyReset();
+        return 0;
+    }
+    if((argc == 3) && (strcmp(argv[1], "post") == 0))
+    {
+        if(strcmp(argv[2], "on") == 0)
+        {
+            g_eLatenciesRW = WRITE_ONLY;
+            return 0;
+        }
+        else if(strcmp(argv[2], "off") == 0)
+        {
+            g_eLatenciesRW = NONE;
+            return 0;
+        }
+    }
+
+    ui32BufLen = snprintf(g_pcTXBuf, TX_BUF_SIZE, "\nlatency [reset | post "
+                          "<on | off>]\n\n    Durations in microseconds, "
+                          "posting is %s.\n",
+                          ((g_eLatenciesRW == NONE) ? "off" : "on"));
+    UART_write(g_psUARTHandle, g_pcTXBuf, ui32BufLen);
+
+    ui32BufLen = snprintf(g_pcTXBuf, TX_BUF_SIZE, "\n    phase      count"
+                          "        min        avg        p95        max\n");
+    UART_write(g_psUARTHandle, g_pcTXBuf, ui32BufLen);
+
+    for(ui32Phase = 0; ui32Phase < NUM_LATENCY_PHASES; ui32Phase++)
+    {
+        psHistogram = &g_psLatency[ui32Phase];
+        ui32BufLen = snprintf(g_pcTXBuf, TX_BUF_SIZE, "    %-5s %10d %10d "
+                              "%10d %10d %10d\n",
+                              g_ppcLatencyPhases[ui32Phase],
+                              psHistogram->ui32Count,
+                              (psHistogram->ui32Count ?
+                               psHistogram->ui32MinUs : 0),
+                              LatencyAverage(psHistogram),
+                              LatencyPercentile(psHistogram, 95),
+                              psHistogram->ui32MaxUs);
+        UART_write(g_psUARTHandle, g_pcTXBuf, ui32BufLen);
+    }
+
+    return 0;
+}
+
 //*****************************************************************************
 //
 // This is the table that holds the command names, implementing functions, and
@@ -563,18 +1036,32 @@ tCmdLineEntry g_psCmdTable[] =
     { "activate",  Cmd_activate,  ": Get a CIK from exosite" },
     { "alert",     Cmd_alert,     ": Send an alert to the saved email "
                                   "address."},
+    { "backoff",   Cmd_backoff,   ": Set or print the retry delays."},
     { "clear",     Cmd_clear,     ": Clear the display " },
     { "connect",   Cmd_connect,   ": Tries to establish a connection with"
                                   " exosite." },
+    { "dnscache",  Cmd_dnscache,  ": Print the DNS cache and its hit rate."},
+    { "endpoints", Cmd_endpoints, ": Print the routes to the server and their "
+                                  "health."},
     { "getmac",    Cmd_getmac,    ": Prints the current MAC address."},
+    { "latency",   Cmd_latency,   ": Print the time taken by each phase of "
+                                  "the requests."},
     { "led",       Cmd_led,       ": Toggle LEDs. Type \"led help\" for more "
                                   "info." },
     { "ntp",       Cmd_ntp,       ": Tries to connenct to the provided IP "
                                   "during start-up!"},
+    { "outbox",    Cmd_outbox,    ": Print the samples waiting to be "
+                                  "uploaded."},
     { "proxy",     Cmd_proxy,     ": Set or disable a HTTP proxy server." },
+    { "sendbuf",   Cmd_sendbuf,   ": Coalesce request writes into larger TLS "
+                                  "records."},
     { "setemail",  Cmd_setemail,  ": Change the email address used for "
                                   "alerts."},
+    { "syncmode",  Cmd_syncmode,  ": Write and read in one request or two."},
+    { "telemetry", Cmd_telemetry, ": Sample the sensors and upload them in "
+                                  "batches."},
     { "tictactoe", Cmd_tictactoe, ": Play tic-tac-toe!"},
+    { "tlsstats",  Cmd_tlsstats,  ": Print TLS session resumption counters."},
     { 0, 0, 0 }
 };
 
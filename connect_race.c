@@ -0,0 +1,278 @@
+//*****************************************************************************
+//
+// connect_race.c - Races TCP connects across the addresses of a host.
+//
+// Copyright (c) 2015 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+//
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+//
+//*****************************************************************************
+
+
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ti/net/network.h>
+#include <ti/sysbios/knl/Clock.h>
+#include "latency.h"
+#include "connect_race.h"
+#include "dns_cache.h"
+
+//*****************************************************************************
+//
+// Returns the milliseconds elapsed since the given clock ticks.
+//
+//*****************************************************************************
+static uint32_t
+RaceElapsed(uint32_t ui32StartTicks)
+{
+    return (((Clock_getTicks() - ui32StartTicks) * Clock_tickPeriod) / 1000);
+}
+
+//*****************************************************************************
+//
+// Starts a non-blocking connect to an address.  Returns the socket, or -1 if
+// the connect failed right away.
+//
+//*****************************************************************************
+static int
+RaceStart(struct sockaddr_in *psSockAddr)
+{
+    int iSocket;
+
+    iSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if(iSocket < 0)
+    {
+        return (-1);
+    }
+
+    fcntl(iSocket, F_SETFL, fcntl(iSocket, F_GETFL, 0) | O_NONBLOCK);
+    if((connect(iSocket, (struct sockaddr *)psSockAddr,
+                sizeof(struct sockaddr_in)) != 0) &&
+       (errno != EINPROGRESS))
+    {
+        close(iSocket);
+        return (-1);
+    }
+
+    return (iSocket);
+}
+
+//*****************************************************************************
+//
+// Looks up the IPv4 addresses of the host in pcAddr, given as
+// "<host>:<port>", in the DNS cache and races TCP connects to them.  A
+// connect is started on the preferred address first, if it is one of them,
+// then on the next address every RACE_STAGGER_MS or as soon as a connect
+// fails.  The address of the first connect to complete is returned in
+// psSockAddr and all the connects are closed, so the caller can connect to it
+// knowing that it answers.  The HTTP client can't take over a socket that is
+// already connected, so that connect costs one more TCP round trip.  An
+// address that doesn't answer then only costs the stagger delay, not a TCP
+// timeout.  ui32Preferred is in network order, 0 if none.  If psTimer is not
+// NULL, the lookup and the race are timed as the LATENCY_DNS and LATENCY_TCP
+// phases.  Returns 0, or -1 if the host can't be resolved or none of its
+// addresses answered.
+//
+//*****************************************************************************
+int32_t
+ConnectRace(const char *pcAddr, uint32_t ui32Preferred,
+            struct sockaddr_in *psSockAddr, tLatencyTimer *psTimer)
+{
+    uint32_t pui32Addrs[RACE_MAX_ADDRESSES];
+    struct sockaddr_in psAddrs[RACE_MAX_ADDRESSES];
+    int piSockets[RACE_MAX_ADDRESSES];
+    char pcHost[DNS_CACHE_NAME_SIZE];
+    const char *pcPort;
+    uint32_t ui32Count, ui32Started, ui32Idx;
+    uint32_t ui32StartTicks, ui32NextMs, ui32Elapsed;
+    int32_t i32Winner, i32Count;
+    struct timeval sTimeout;
+    fd_set sWriteSet;
+    int iMax, iError;
+    socklen_t sLen;
+
+    //
+    // Split the address into the host and the port.
+    //
+    pcPort = strrchr(pcAddr, ':');
+    if((pcPort == NULL) || ((pcPort - pcAddr) >= sizeof(pcHost)))
+    {
+        return (-1);
+    }
+    memcpy(pcHost, pcAddr, pcPort - pcAddr);
+    pcHost[pcPort - pcAddr] = '\0';
+
+    //
+    // Look up the addresses of the host.  The preferred one, that answered
+    // last time, goes first.
+    //
+    i32Count = DNSCacheLookup(pcHost, pui32Addrs, RACE_MAX_ADDRESSES);
+    if(i32Count <= 0)
+    {
+        return (-1);
+    }
+    if(psTimer != NULL)
+    {
+        LatencyMark(psTimer, LATENCY_DNS);
+    }
+    ui32Count = (uint32_t)i32Count;
+
+    for(ui32Idx = 0; ui32Idx < ui32Count; ui32Idx++)
+    {
+        memset(&psAddrs[ui32Idx], 0, sizeof(struct sockaddr_in));
+        psAddrs[ui32Idx].sin_family = AF_INET;
+        psAddrs[ui32Idx].sin_port = htons(atoi(pcPort + 1));
+        psAddrs[ui32Idx].sin_addr.s_addr = pui32Addrs[ui32Idx];
+        if((pui32Addrs[ui32Idx] == ui32Preferred) && (ui32Idx != 0))
+        {
+            psAddrs[ui32Idx].sin_addr.s_addr = pui32Addrs[0];
+            psAddrs[0].sin_addr.s_addr = ui32Preferred;
+        }
+    }
+
+    //
+    // Race the connects until one completes, all of them failed or the time
+    // is up.
+    //
+    i32Winner = -1;
+    ui32Started = 0;
+    ui32NextMs = 0;
+    ui32StartTicks = Clock_getTicks();
+    while(1)
+    {
+        ui32Elapsed = RaceElapsed(ui32StartTicks);
+
+        //
+        // Start a connect to the next address when its turn has come.
+        //
+        if((ui32Started < ui32Count) && (ui32Elapsed >= ui32NextMs))
+        {
+            piSockets[ui32Started] = RaceStart(&psAddrs[ui32Started]);
+            ui32Started++;
+            ui32NextMs = ui32Elapsed + RACE_STAGGER_MS;
+            continue;
+        }
+
+        //
+        // Wait for a connect to complete, until the next one is due.
+        //
+        FD_ZERO(&sWriteSet);
+        iMax = -1;
+        for(ui32Idx = 0; ui32Idx < ui32Started; ui32Idx++)
+        {
+            if(piSockets[ui32Idx] >= 0)
+            {
+                FD_SET(piSockets[ui32Idx], &sWriteSet);
+                if(piSockets[ui32Idx] > iMax)
+                {
+                    iMax = piSockets[ui32Idx];
+                }
+            }
+        }
+
+        if(ui32Elapsed >= RACE_TIMEOUT_MS)
+        {
+            break;
+        }
+        if(iMax < 0)
+        {
+            //
+            // All the connects started so far failed.  Start the next one
+            // right away, if there is one left.
+            //
+            if(ui32Started == ui32Count)
+            {
+                break;
+            }
+            ui32NextMs = ui32Elapsed;
+            continue;
+        }
+
+        ui32NextMs = ((ui32Started < ui32Count) ? ui32NextMs :
+                      RACE_TIMEOUT_MS);
+        if(ui32NextMs > RACE_TIMEOUT_MS)
+        {
+            ui32NextMs = RACE_TIMEOUT_MS;
+        }
+        sTimeout.tv_sec = (ui32NextMs - ui32Elapsed) / 1000;
+        sTimeout.tv_usec = ((ui32NextMs - ui32Elapsed) % 1000) * 1000;
+        if(select(iMax + 1, NULL, &sWriteSet, NULL, &sTimeout) <= 0)
+        {
+            continue;
+        }
+
+        //
+        // A writable socket finished its connect, with or without success.
+        //
+        for(ui32Idx = 0; ui32Idx < ui32Started; ui32Idx++)
+        {
+            if((piSockets[ui32Idx] < 0) ||
+               !FD_ISSET(piSockets[ui32Idx], &sWriteSet))
+            {
+                continue;
+            }
+
+            iError = 0;
+            sLen = sizeof(iError);
+            getsockopt(piSockets[ui32Idx], SOL_SOCKET, SO_ERROR, &iError,
+                       &sLen);
+            if(iError == 0)
+            {
+                i32Winner = ui32Idx;
+                break;
+            }
+
+            close(piSockets[ui32Idx]);
+            piSockets[ui32Idx] = -1;
+        }
+
+        if(i32Winner >= 0)
+        {
+            break;
+        }
+    }
+
+    //
+    // Close all the connects, the caller makes its own.
+    //
+    for(ui32Idx = 0; ui32Idx < ui32Started; ui32Idx++)
+    {
+        if(piSockets[ui32Idx] >= 0)
+        {
+            close(piSockets[ui32Idx]);
+        }
+    }
+
+    //
+    // If none of the addresses answered, they may have changed.  Look the
+    // host up again next time.
+    //
+    if(i32Winner < 0)
+    {
+        DNSCacheInvalidate(pcHost);
+        return (-1);
+    }
+
+    *psSockAddr = psAddrs[i32Winner];
+    if(psTimer != NULL)
+    {
+        LatencyMark(psTimer, LATENCY_TCP);
+    }
+    return (0);
+}
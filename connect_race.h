@@ -0,0 +1,49 @@
+//*****************************************************************************
+//
+// connect_race.h - Races TCP connects across the addresses of a host.
+//
+// Copyright (c) 2015 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+//
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+//
+//*****************************************************************************
+
+
+#ifndef __CONNECT_RACE_H__
+#define __CONNECT_RACE_H__
+
+//*****************************************************************************
+//
+// Parameters of the race.  Up to RACE_MAX_ADDRESSES addresses of a host are
+// raced.  A connect is started on the next address every RACE_STAGGER_MS, or
+// as soon as one fails, and the race is lost if no connect completed after
+// RACE_TIMEOUT_MS.  Times are in milliseconds.
+//
+//*****************************************************************************
+#define RACE_MAX_ADDRESSES      4
+#define RACE_STAGGER_MS         250
+#define RACE_TIMEOUT_MS         10000
+
+//*****************************************************************************
+//
+// Prototypes of the functions that are called from outside the
+// connect_race.c module.
+//
+//*****************************************************************************
+extern int32_t ConnectRace(const char *pcAddr, uint32_t ui32Preferred,
+                           struct sockaddr_in *psSockAddr,
+                           tLatencyTimer *psTimer);
+
+#endif // __CONNECT_RACE_H__
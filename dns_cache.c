@@ -0,0 +1,355 @@
+//*****************************************************************************
+//
+// dns_cache.c - Cache of the resolved addresses of host names.
+//
+// Copyright (c) 2015 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+//
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+//
+//*****************************************************************************
+
+
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <xdc/std.h>
+#include <ti/net/network.h>
+#include <ti/sysbios/knl/Clock.h>
+#include <ti/sysbios/knl/Task.h>
+#include "dns_cache.h"
+
+//*****************************************************************************
+//
+// A cached host name.  An entry with no address is empty.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // The host name.
+    //
+    char pcName[DNS_CACHE_NAME_SIZE];
+
+    //
+    // Its IPv4 addresses, in network order.
+    //
+    uint32_t pui32Addrs[DNS_CACHE_ADDRESSES];
+    uint32_t ui32Count;
+
+    //
+    // Clock ticks when the name was resolved.
+    //
+    uint32_t ui32Ticks;
+
+    //
+    // The entry was used after it expired and needs to be resolved again.
+    //
+    bool bRefresh;
+} tDNSEntry;
+
+//*****************************************************************************
+//
+// The cache and its counters.  The entries are shared by the Cloud and the
+// long-poll tasks, so they are only accessed with the scheduler disabled.
+// Names are resolved with the scheduler enabled.
+//
+//*****************************************************************************
+static tDNSEntry g_psDNSCache[DNS_CACHE_ENTRIES];
+tDNSCacheStats g_sDNSCacheStats;
+
+//*****************************************************************************
+//
+// Returns the age of an entry in seconds.
+//
+//*****************************************************************************
+static uint32_t
+DNSEntryAge(const tDNSEntry *psEntry)
+{
+    return ((Clock_getTicks() - psEntry->ui32Ticks) /
+            (1000000 / Clock_tickPeriod));
+}
+
+//*****************************************************************************
+//
+// Returns the entry of a host name, or NULL if it is not cached.
+//
+//*****************************************************************************
+static tDNSEntry *
+DNSEntryFind(const char *pcHost)
+{
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < DNS_CACHE_ENTRIES; ui32Idx++)
+    {
+        if((g_psDNSCache[ui32Idx].ui32Count != 0) &&
+           (strcmp(g_psDNSCache[ui32Idx].pcName, pcHost) == 0))
+        {
+            return (&g_psDNSCache[ui32Idx]);
+        }
+    }
+
+    return (NULL);
+}
+
+//*****************************************************************************
+//
+// Resolves the IPv4 addresses of a host name with the resolver of the network
+// stack.  Returns the number of addresses, 0 if there is none.
+//
+//*****************************************************************************
+static uint32_t
+DNSResolve(const char *pcHost, uint32_t *pui32Addrs)
+{
+    struct addrinfo sHints;
+    struct addrinfo *psResult, *psInfo;
+    uint32_t ui32Count;
+
+    memset(&sHints, 0, sizeof(sHints));
+    sHints.ai_family = AF_INET;
+    sHints.ai_socktype = SOCK_STREAM;
+    if(getaddrinfo(pcHost, NULL, &sHints, &psResult) != 0)
+    {
+        return (0);
+    }
+
+    ui32Count = 0;
+    for(psInfo = psResult; (psInfo != NULL) &&
+        (ui32Count < DNS_CACHE_ADDRESSES); psInfo = psInfo->ai_next)
+    {
+        pui32Addrs[ui32Count++] =
+            ((struct sockaddr_in *)psInfo->ai_addr)->sin_addr.s_addr;
+    }
+    freeaddrinfo(psResult);
+
+    return (ui32Count);
+}
+
+//*****************************************************************************
+//
+// Stores the addresses of a host name in its entry, or in an empty entry, or
+// in place of the oldest entry.
+//
+//*****************************************************************************
+static void
+DNSEntryStore(const char *pcHost, const uint32_t *pui32Addrs,
+              uint32_t ui32Count)
+{
+    tDNSEntry *psEntry;
+    uint32_t ui32Idx, ui32Oldest, ui32Age, ui32OldestAge;
+    UInt uKey;
+
+    if(strlen(pcHost) >= DNS_CACHE_NAME_SIZE)
+    {
+        return;
+    }
+
+    uKey = Task_disable();
+
+    psEntry = DNSEntryFind(pcHost);
+    for(ui32Idx = 0; (psEntry == NULL) && (ui32Idx < DNS_CACHE_ENTRIES);
+        ui32Idx++)
+    {
+        if(g_psDNSCache[ui32Idx].ui32Count == 0)
+        {
+            psEntry = &g_psDNSCache[ui32Idx];
+        }
+    }
+
+    //
+    // The cache is full, so replace the entry that was resolved the longest
+    // time ago.
+    //
+    if(psEntry == NULL)
+    {
+        ui32Oldest = 0;
+        ui32OldestAge = DNSEntryAge(&g_psDNSCache[0]);
+        for(ui32Idx = 1; ui32Idx < DNS_CACHE_ENTRIES; ui32Idx++)
+        {
+            ui32Age = DNSEntryAge(&g_psDNSCache[ui32Idx]);
+            if(ui32Age > ui32OldestAge)
+            {
+                ui32Oldest = ui32Idx;
+                ui32OldestAge = ui32Age;
+            }
+        }
+        psEntry = &g_psDNSCache[ui32Oldest];
+    }
+
+    strcpy(psEntry->pcName, pcHost);
+    memcpy(psEntry->pui32Addrs, pui32Addrs, ui32Count * sizeof(uint32_t));
+    psEntry->ui32Count = ui32Count;
+    psEntry->ui32Ticks = Clock_getTicks();
+    psEntry->bRefresh = false;
+
+    Task_restore(uKey);
+}
+
+//*****************************************************************************
+//
+// Looks up the IPv4 addresses of a host name, up to ui32Max of them, in
+// network order.  A cached entry is used while it is fresh, and for a while
+// after it expired, so a lookup doesn't wait for the network unless the name
+// was never resolved.  Returns the number of addresses, or -1 if the name
+// can't be resolved.
+//
+//*****************************************************************************
+int32_t
+DNSCacheLookup(const char *pcHost, uint32_t *pui32Addrs, uint32_t ui32Max)
+{
+    uint32_t pui32Resolved[DNS_CACHE_ADDRESSES];
+    tDNSEntry *psEntry;
+    uint32_t ui32Count, ui32Age;
+    UInt uKey;
+
+    uKey = Task_disable();
+
+    ui32Count = 0;
+    psEntry = DNSEntryFind(pcHost);
+    if(psEntry != NULL)
+    {
+        ui32Age = DNSEntryAge(psEntry);
+        if(ui32Age < DNS_CACHE_TTL)
+        {
+            g_sDNSCacheStats.ui32Hits++;
+            ui32Count = psEntry->ui32Count;
+        }
+        else if(ui32Age < (DNS_CACHE_TTL + DNS_CACHE_STALE))
+        {
+            g_sDNSCacheStats.ui32StaleHits++;
+            psEntry->bRefresh = true;
+            ui32Count = psEntry->ui32Count;
+        }
+        else
+        {
+            psEntry->ui32Count = 0;
+        }
+    }
+
+    if(ui32Count != 0)
+    {
+        ui32Count = ((ui32Count < ui32Max) ? ui32Count : ui32Max);
+        memcpy(pui32Addrs, psEntry->pui32Addrs, ui32Count * sizeof(uint32_t));
+        Task_restore(uKey);
+        return (ui32Count);
+    }
+
+    g_sDNSCacheStats.ui32Misses++;
+    Task_restore(uKey);
+
+    //
+    // Not cached.  Resolve the name now.
+    //
+    ui32Count = DNSResolve(pcHost, pui32Resolved);
+    if(ui32Count == 0)
+    {
+        g_sDNSCacheStats.ui32Failures++;
+        return (-1);
+    }
+    DNSEntryStore(pcHost, pui32Resolved, ui32Count);
+
+    ui32Count = ((ui32Count < ui32Max) ? ui32Count : ui32Max);
+    memcpy(pui32Addrs, pui32Resolved, ui32Count * sizeof(uint32_t));
+    return (ui32Count);
+}
+
+//*****************************************************************************
+//
+// Drops the entry of a host name, for instance after none of its addresses
+// answered.  The next lookup resolves it again.
+//
+//*****************************************************************************
+void
+DNSCacheInvalidate(const char *pcHost)
+{
+    tDNSEntry *psEntry;
+    UInt uKey;
+
+    uKey = Task_disable();
+    psEntry = DNSEntryFind(pcHost);
+    if(psEntry != NULL)
+    {
+        psEntry->ui32Count = 0;
+    }
+    Task_restore(uKey);
+}
+
+//*****************************************************************************
+//
+// Resolves again one of the expired entries that are still in use.  This is
+// called by the Cloud task between syncs, so the connect path doesn't wait
+// for it.  If the name can't be resolved, the stale entry is kept.
+//
+//*****************************************************************************
+void
+DNSCacheRefresh(void)
+{
+    uint32_t pui32Resolved[DNS_CACHE_ADDRESSES];
+    char pcHost[DNS_CACHE_NAME_SIZE];
+    uint32_t ui32Idx, ui32Count;
+    UInt uKey;
+
+    pcHost[0] = '\0';
+    uKey = Task_disable();
+    for(ui32Idx = 0; ui32Idx < DNS_CACHE_ENTRIES; ui32Idx++)
+    {
+        if((g_psDNSCache[ui32Idx].ui32Count != 0) &&
+           g_psDNSCache[ui32Idx].bRefresh)
+        {
+            g_psDNSCache[ui32Idx].bRefresh = false;
+            strcpy(pcHost, g_psDNSCache[ui32Idx].pcName);
+            break;
+        }
+    }
+    Task_restore(uKey);
+
+    if(pcHost[0] == '\0')
+    {
+        return;
+    }
+
+    ui32Count = DNSResolve(pcHost, pui32Resolved);
+    if(ui32Count == 0)
+    {
+        g_sDNSCacheStats.ui32Failures++;
+        return;
+    }
+
+    DNSEntryStore(pcHost, pui32Resolved, ui32Count);
+    g_sDNSCacheStats.ui32Refreshes++;
+}
+
+//*****************************************************************************
+//
+// Copies the host name of an entry to pcHost, which must hold
+// DNS_CACHE_NAME_SIZE characters, and its age in seconds to pui32Age.
+// Returns the number of addresses of the entry, 0 if it is empty.
+//
+//*****************************************************************************
+uint32_t
+DNSCacheEntry(uint32_t ui32Idx, char *pcHost, uint32_t *pui32Age)
+{
+    uint32_t ui32Count;
+    UInt uKey;
+
+    uKey = Task_disable();
+    ui32Count = g_psDNSCache[ui32Idx].ui32Count;
+    strcpy(pcHost, g_psDNSCache[ui32Idx].pcName);
+    *pui32Age = DNSEntryAge(&g_psDNSCache[ui32Idx]);
+    Task_restore(uKey);
+
+    return (ui32Count);
+}
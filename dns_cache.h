@@ -0,0 +1,76 @@
+//*****************************************************************************
+//
+// dns_cache.h - Cache of the resolved addresses of host names.
+//
+// Copyright (c) 2015 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+//
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+//
+//*****************************************************************************
+
+
+#ifndef __DNS_CACHE_H__
+#define __DNS_CACHE_H__
+
+//*****************************************************************************
+//
+// Cache size, in host names and in addresses kept per name.
+//
+//*****************************************************************************
+#define DNS_CACHE_ENTRIES       4
+#define DNS_CACHE_ADDRESSES     4
+#define DNS_CACHE_NAME_SIZE     64
+
+//*****************************************************************************
+//
+// Lifetime of an entry in seconds.  The resolver of the network stack does
+// not return the TTL of the records, so a fixed TTL is used.  Once it has
+// expired, an entry is still used for up to DNS_CACHE_STALE seconds while it
+// is refreshed by DNSCacheRefresh().
+//
+//*****************************************************************************
+#define DNS_CACHE_TTL           300
+#define DNS_CACHE_STALE         3600
+
+//*****************************************************************************
+//
+// Cache counters.  A stale hit is a lookup answered from an expired entry.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32Hits;
+    uint32_t ui32StaleHits;
+    uint32_t ui32Misses;
+    uint32_t ui32Refreshes;
+    uint32_t ui32Failures;
+} tDNSCacheStats;
+
+extern tDNSCacheStats g_sDNSCacheStats;
+
+//*****************************************************************************
+//
+// Prototypes of the functions that are called from outside the dns_cache.c
+// module.
+//
+//*****************************************************************************
+extern int32_t DNSCacheLookup(const char *pcHost, uint32_t *pui32Addrs,
+                              uint32_t ui32Max);
+extern void DNSCacheInvalidate(const char *pcHost);
+extern void DNSCacheRefresh(void);
+extern uint32_t DNSCacheEntry(uint32_t ui32Idx, char *pcHost,
+                              uint32_t *pui32Age);
+
+#endif // __DNS_CACHE_H__
@@ -0,0 +1,206 @@
+//*****************************************************************************
+//
+// endpoint.c - Health scoring of the routes to the cloud server.
+//
+// Copyright (c) 2015 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+//
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+//
+//*****************************************************************************
+
+
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "endpoint.h"
+
+//*****************************************************************************
+//
+// Sets the address of an endpoint, or clears it if pcAddr is NULL or empty.
+// The health of the previous address is forgotten.
+//
+//*****************************************************************************
+void
+EndpointSet(tEndpoint *psEndpoint, const char *pcAddr)
+{
+    psEndpoint->pcAddr[0] = '\0';
+    if(pcAddr != NULL)
+    {
+        strncpy(psEndpoint->pcAddr, pcAddr, ENDPOINT_ADDR_SIZE - 1);
+        psEndpoint->pcAddr[ENDPOINT_ADDR_SIZE - 1] = '\0';
+    }
+
+    psEndpoint->ui32LastAddr = 0;
+    psEndpoint->ui32LatencyMs = 0;
+    psEndpoint->ui32ErrorRate = 0;
+    psEndpoint->ui32Failures = 0;
+    psEndpoint->ui32HoldTicks = 0;
+}
+
+//*****************************************************************************
+//
+// Returns the score of an endpoint, lower is better.  This is the expected
+// connect time in milliseconds plus a penalty that grows with the error rate.
+//
+//*****************************************************************************
+uint32_t
+EndpointScore(const tEndpoint *psEndpoint)
+{
+    uint32_t ui32Score;
+
+    ui32Score = ((psEndpoint->ui32LatencyMs != 0) ?
+                 psEndpoint->ui32LatencyMs : ENDPOINT_UNKNOWN_MS);
+    ui32Score += ((psEndpoint->ui32ErrorRate * ENDPOINT_ERROR_PENALTY) /
+                  ENDPOINT_RATE_ONE);
+
+    return (ui32Score);
+}
+
+//*****************************************************************************
+//
+// Returns true if the endpoint is configured and not demoted at the given
+// clock ticks.
+//
+//*****************************************************************************
+bool
+EndpointHealthy(const tEndpoint *psEndpoint, uint32_t ui32Ticks)
+{
+    if(psEndpoint->pcAddr[0] == '\0')
+    {
+        return (false);
+    }
+
+    return ((psEndpoint->ui32Failures < ENDPOINT_DEMOTE_FAILURES) ||
+            ((int32_t)(ui32Ticks - psEndpoint->ui32HoldTicks) >= 0));
+}
+
+//*****************************************************************************
+//
+// Returns the index of the healthy endpoint with the best score, not counting
+// those whose bit is set in ui32Skip.  Ties go to the first in the list.  If
+// none is healthy and none was skipped, the configured endpoint with the best
+// score is returned so there is always one to try.  Returns -1 if there is
+// no endpoint to try.
+//
+//*****************************************************************************
+int32_t
+EndpointSelect(const tEndpoint *psEndpoints, uint32_t ui32Count,
+               uint32_t ui32Skip, uint32_t ui32Ticks)
+{
+    int32_t i32Best, i32Fallback;
+    uint32_t ui32Best, ui32Fallback, ui32Score;
+    uint32_t ui32Idx;
+
+    i32Best = -1;
+    i32Fallback = -1;
+    ui32Best = 0;
+    ui32Fallback = 0;
+    for(ui32Idx = 0; ui32Idx < ui32Count; ui32Idx++)
+    {
+        if((ui32Skip & (1 << ui32Idx)) ||
+           (psEndpoints[ui32Idx].pcAddr[0] == '\0'))
+        {
+            continue;
+        }
+
+        ui32Score = EndpointScore(&psEndpoints[ui32Idx]);
+        if((i32Fallback < 0) || (ui32Score < ui32Fallback))
+        {
+            i32Fallback = ui32Idx;
+            ui32Fallback = ui32Score;
+        }
+        if(EndpointHealthy(&psEndpoints[ui32Idx], ui32Ticks) &&
+           ((i32Best < 0) || (ui32Score < ui32Best)))
+        {
+            i32Best = ui32Idx;
+            ui32Best = ui32Score;
+        }
+    }
+
+    return (((i32Best < 0) && (ui32Skip == 0)) ? i32Fallback : i32Best);
+}
+
+//*****************************************************************************
+//
+// Records a successful connect that took ui32LatencyMs.
+//
+//*****************************************************************************
+void
+EndpointSuccess(tEndpoint *psEndpoint, uint32_t ui32LatencyMs)
+{
+    if(psEndpoint->ui32LatencyMs == 0)
+    {
+        psEndpoint->ui32LatencyMs = ui32LatencyMs;
+    }
+    else
+    {
+        psEndpoint->ui32LatencyMs -= (psEndpoint->ui32LatencyMs /
+                                      ENDPOINT_AVERAGE_WEIGHT);
+        psEndpoint->ui32LatencyMs += (ui32LatencyMs /
+                                      ENDPOINT_AVERAGE_WEIGHT);
+    }
+
+    //
+    // Keep 0 for an endpoint that was never connected.
+    //
+    if(psEndpoint->ui32LatencyMs == 0)
+    {
+        psEndpoint->ui32LatencyMs = 1;
+    }
+
+    //
+    // Round the decay up, or the error rate would never drop below
+    // ENDPOINT_AVERAGE_WEIGHT - 1 and an endpoint that failed once would be
+    // penalized for good.
+    //
+    psEndpoint->ui32ErrorRate -= ((psEndpoint->ui32ErrorRate +
+                                   (ENDPOINT_AVERAGE_WEIGHT - 1)) /
+                                  ENDPOINT_AVERAGE_WEIGHT);
+    psEndpoint->ui32Failures = 0;
+    psEndpoint->ui32Connects++;
+}
+
+//*****************************************************************************
+//
+// Records a failed connect, or an error on a connection.  Once it failed
+// ENDPOINT_DEMOTE_FAILURES times in a row, the endpoint is demoted until
+// ui32HoldTicks times the number of further failures have passed.
+//
+//*****************************************************************************
+void
+EndpointFailure(tEndpoint *psEndpoint, uint32_t ui32Ticks,
+                uint32_t ui32HoldTicks)
+{
+    uint32_t ui32Steps;
+
+    psEndpoint->ui32ErrorRate -= (psEndpoint->ui32ErrorRate /
+                                  ENDPOINT_AVERAGE_WEIGHT);
+    psEndpoint->ui32ErrorRate += (ENDPOINT_RATE_ONE /
+                                  ENDPOINT_AVERAGE_WEIGHT);
+    psEndpoint->ui32Failures++;
+    psEndpoint->ui32Errors++;
+
+    if(psEndpoint->ui32Failures >= ENDPOINT_DEMOTE_FAILURES)
+    {
+        ui32Steps = (psEndpoint->ui32Failures - ENDPOINT_DEMOTE_FAILURES) + 1;
+        if(ui32Steps > ENDPOINT_HOLD_STEPS)
+        {
+            ui32Steps = ENDPOINT_HOLD_STEPS;
+        }
+        psEndpoint->ui32HoldTicks = ui32Ticks + (ui32HoldTicks * ui32Steps);
+    }
+}
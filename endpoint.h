@@ -0,0 +1,125 @@
+//*****************************************************************************
+//
+// endpoint.h - Health scoring of the routes to the cloud server.
+//
+// Copyright (c) 2015 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+//
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+//
+//*****************************************************************************
+
+
+#ifndef __ENDPOINT_H__
+#define __ENDPOINT_H__
+
+//*****************************************************************************
+//
+// Size of the "<host>:<port>" address of an endpoint, including the 0.
+//
+//*****************************************************************************
+#define ENDPOINT_ADDR_SIZE      50
+
+//*****************************************************************************
+//
+// Scoring parameters.  The connect time and the error rate are rolling
+// averages that give each new sample a weight of 1/ENDPOINT_AVERAGE_WEIGHT.
+// The error rate is a fraction of ENDPOINT_RATE_ONE.  An endpoint that was
+// never connected is scored as if it took ENDPOINT_UNKNOWN_MS, so one that is
+// known to work is preferred.  ENDPOINT_ERROR_PENALTY is the score, in
+// milliseconds, of an error rate of 100%.  After ENDPOINT_DEMOTE_FAILURES
+// failures in a row, an endpoint is demoted for the hold time given to
+// EndpointFailure(), times the number of failures past the limit, up to
+// ENDPOINT_HOLD_STEPS times.
+//
+//*****************************************************************************
+#define ENDPOINT_AVERAGE_WEIGHT 4
+#define ENDPOINT_RATE_ONE       256
+#define ENDPOINT_UNKNOWN_MS     5000
+#define ENDPOINT_ERROR_PENALTY  20000
+#define ENDPOINT_DEMOTE_FAILURES 2
+#define ENDPOINT_HOLD_STEPS     8
+
+//*****************************************************************************
+//
+// A route to the cloud server, either straight to a host or through a HTTP
+// proxy, with its health.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // Name of the endpoint, shown on the console.
+    //
+    const char *pcName;
+
+    //
+    // Address as "<host>:<port>", or an empty string if the endpoint is not
+    // configured.
+    //
+    char pcAddr[ENDPOINT_ADDR_SIZE];
+
+    //
+    // The address is a HTTP proxy rather than the server.
+    //
+    bool bProxy;
+
+    //
+    // IP address, in network order, that the host answered on last, or 0.
+    // It is tried first on the next connect.
+    //
+    uint32_t ui32LastAddr;
+
+    //
+    // Rolling average of the connect time in milliseconds, or 0 if the
+    // endpoint was never connected.
+    //
+    uint32_t ui32LatencyMs;
+
+    //
+    // Rolling average of the error rate, out of ENDPOINT_RATE_ONE.
+    //
+    uint32_t ui32ErrorRate;
+
+    //
+    // Number of failures in a row, and the clock ticks until which the
+    // endpoint is demoted.
+    //
+    uint32_t ui32Failures;
+    uint32_t ui32HoldTicks;
+
+    //
+    // Total number of successful connects and of errors.
+    //
+    uint32_t ui32Connects;
+    uint32_t ui32Errors;
+} tEndpoint;
+
+//*****************************************************************************
+//
+// Prototypes of the functions that are called from outside the endpoint.c
+// module.
+//
+//*****************************************************************************
+extern void EndpointSet(tEndpoint *psEndpoint, const char *pcAddr);
+extern uint32_t EndpointScore(const tEndpoint *psEndpoint);
+extern bool EndpointHealthy(const tEndpoint *psEndpoint, uint32_t ui32Ticks);
+extern int32_t EndpointSelect(const tEndpoint *psEndpoints,
+                              uint32_t ui32Count, uint32_t ui32Skip,
+                              uint32_t ui32Ticks);
+extern void EndpointSuccess(tEndpoint *psEndpoint, uint32_t ui32LatencyMs);
+extern void EndpointFailure(tEndpoint *psEndpoint, uint32_t ui32Ticks,
+                            uint32_t ui32HoldTicks);
+
+#endif // __ENDPOINT_H__
@@ -0,0 +1,187 @@
+//*****************************************************************************
+//
+// fast_format.c - Bounded string formatting without snprintf.
+//
+// Copyright (c) 2015 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+//
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+//
+//*****************************************************************************
+
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "fast_format.h"
+#include "url_codec.h"
+
+//*****************************************************************************
+//
+// Hexadecimal digits.
+//
+//*****************************************************************************
+static const char g_pcHexDigits[] = "0123456789abcdef";
+
+//*****************************************************************************
+//
+// Reserves ui32Len characters at the end of the text.  Returns a pointer to
+// them, or NULL if they don't fit, in which case the cursor is marked
+// truncated.
+//
+//*****************************************************************************
+static char *
+FormatReserve(tFormatCursor *psCursor, uint32_t ui32Len)
+{
+    char *pcOut;
+
+    if(psCursor->bTruncated ||
+       (ui32Len >= (psCursor->ui32Size - psCursor->ui32Len)))
+    {
+        psCursor->bTruncated = true;
+        return (NULL);
+    }
+
+    pcOut = psCursor->pcBuf + psCursor->ui32Len;
+    psCursor->ui32Len += ui32Len;
+    psCursor->pcBuf[psCursor->ui32Len] = '\0';
+
+    return (pcOut);
+}
+
+//*****************************************************************************
+//
+// Initialize a cursor that appends to pcBuf, which holds ui32Size bytes.
+//
+//*****************************************************************************
+void
+FormatInit(tFormatCursor *psCursor, char *pcBuf, uint32_t ui32Size)
+{
+    psCursor->pcBuf = pcBuf;
+    psCursor->ui32Size = ui32Size;
+    psCursor->ui32Len = 0;
+    psCursor->bTruncated = (ui32Size == 0);
+    if(ui32Size != 0)
+    {
+        pcBuf[0] = '\0';
+    }
+}
+
+//*****************************************************************************
+//
+// Appends ui32Len characters of pcStr.  Returns false, and appends nothing,
+// if they don't fit.
+//
+//*****************************************************************************
+bool
+FormatBytes(tFormatCursor *psCursor, const char *pcStr, uint32_t ui32Len)
+{
+    char *pcOut;
+
+    pcOut = FormatReserve(psCursor, ui32Len);
+    if(pcOut == NULL)
+    {
+        return (false);
+    }
+
+    memcpy(pcOut, pcStr, ui32Len);
+
+    return (true);
+}
+
+//*****************************************************************************
+//
+// Appends a 0 terminated string.  Returns false, and appends nothing, if it
+// doesn't fit.
+//
+//*****************************************************************************
+bool
+FormatString(tFormatCursor *psCursor, const char *pcStr)
+{
+    return (FormatBytes(psCursor, pcStr, strlen(pcStr)));
+}
+
+//*****************************************************************************
+//
+// Appends an unsigned number in decimal.  The digits are produced backwards
+// in a small local buffer, which avoids a division to count them first.
+// Returns false, and appends nothing, if the number doesn't fit.
+//
+//*****************************************************************************
+bool
+FormatDecimal(tFormatCursor *psCursor, uint32_t ui32Value)
+{
+    char pcDigits[10];
+    uint32_t ui32Idx = sizeof(pcDigits);
+
+    do
+    {
+        pcDigits[--ui32Idx] = '0' + (ui32Value % 10);
+        ui32Value /= 10;
+    } while(ui32Value != 0);
+
+    return (FormatBytes(psCursor, pcDigits + ui32Idx,
+                        sizeof(pcDigits) - ui32Idx));
+}
+
+//*****************************************************************************
+//
+// Appends an unsigned number in lower case hexadecimal, with a "0x" prefix.
+// Returns false, and appends nothing, if the number doesn't fit.
+//
+//*****************************************************************************
+bool
+FormatHex(tFormatCursor *psCursor, uint32_t ui32Value)
+{
+    char pcDigits[10];
+    uint32_t ui32Idx = sizeof(pcDigits);
+
+    do
+    {
+        pcDigits[--ui32Idx] = g_pcHexDigits[ui32Value & 0xF];
+        ui32Value >>= 4;
+    } while(ui32Value != 0);
+
+    pcDigits[--ui32Idx] = 'x';
+    pcDigits[--ui32Idx] = '0';
+
+    return (FormatBytes(psCursor, pcDigits + ui32Idx,
+                        sizeof(pcDigits) - ui32Idx));
+}
+
+//*****************************************************************************
+//
+// Appends a 0 terminated string, URL encoded for a form-urlencoded body or a
+// query string.  Returns false, and appends nothing, if the encoded string
+// doesn't fit.
+//
+//*****************************************************************************
+bool
+FormatURLEncoded(tFormatCursor *psCursor, const char *pcStr)
+{
+    uint32_t ui32Len;
+    char *pcOut;
+
+    ui32Len = strlen(pcStr);
+    pcOut = FormatReserve(psCursor, URLEncodedLength(pcStr, ui32Len));
+    if(pcOut == NULL)
+    {
+        return (false);
+    }
+
+    URLEncode(pcOut, pcStr, ui32Len);
+
+    return (true);
+}
@@ -0,0 +1,71 @@
+//*****************************************************************************
+//
+// fast_format.h - Bounded string formatting without snprintf.
+//
+// Copyright (c) 2015 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+//
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+//
+//*****************************************************************************
+
+
+
+#ifndef __FAST_FORMAT_H__
+#define __FAST_FORMAT_H__
+
+//*****************************************************************************
+//
+// Output cursor of the formatting functions.  The text is appended to a
+// caller supplied buffer that is always kept 0 terminated.  Once an append
+// doesn't fit, the cursor is marked truncated and every later append is
+// dropped, so a chain of appends only needs to be checked once at the end.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // Buffer the text is appended to, and its size including the
+    // terminating 0.
+    //
+    char *pcBuf;
+    uint32_t ui32Size;
+
+    //
+    // Length of the text in the buffer.
+    //
+    uint32_t ui32Len;
+
+    //
+    // Set when an append did not fit in the buffer.
+    //
+    bool bTruncated;
+} tFormatCursor;
+
+//*****************************************************************************
+//
+// Prototypes of the functions that are called from outside the fast_format.c
+// module.
+//
+//*****************************************************************************
+extern void FormatInit(tFormatCursor *psCursor, char *pcBuf,
+                       uint32_t ui32Size);
+extern bool FormatBytes(tFormatCursor *psCursor, const char *pcStr,
+                        uint32_t ui32Len);
+extern bool FormatString(tFormatCursor *psCursor, const char *pcStr);
+extern bool FormatDecimal(tFormatCursor *psCursor, uint32_t ui32Value);
+extern bool FormatHex(tFormatCursor *psCursor, uint32_t ui32Value);
+extern bool FormatURLEncoded(tFormatCursor *psCursor, const char *pcStr);
+
+#endif // __FAST_FORMAT_H__
@@ -0,0 +1,141 @@
+//*****************************************************************************
+//
+// form_parser.c - Incremental parser for form-urlencoded response bodies.
+//
+// Copyright (c) 2015 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+//
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+//
+//*****************************************************************************
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "form_parser.h"
+#include "url_codec.h"
+
+//*****************************************************************************
+//
+// Pass the current field to the handler and get ready for the next one.  The
+// key and value are URL decoded first.  A field whose key did not fit is
+// dropped, as it can't match a known key.
+//
+//*****************************************************************************
+static void
+FormParserDispatch(tFormParser *psParser)
+{
+    if((psParser->ui32KeyLen != 0) && !psParser->bKeyTruncated)
+    {
+        URLDecode(psParser->pcKey, psParser->ui32KeyLen);
+        URLDecode(psParser->pcValue, psParser->ui32ValueLen);
+        psParser->pfnHandler(psParser->pcKey, psParser->pcValue,
+                             psParser->bValueTruncated);
+    }
+
+    psParser->bInValue = false;
+    psParser->bKeyTruncated = false;
+    psParser->bValueTruncated = false;
+    psParser->ui32KeyLen = 0;
+    psParser->ui32ValueLen = 0;
+}
+
+//*****************************************************************************
+//
+// Initialize a parser for a new body.
+//
+//*****************************************************************************
+void
+FormParserInit(tFormParser *psParser, tFormFieldHandler pfnHandler)
+{
+    psParser->pfnHandler = pfnHandler;
+    psParser->bInValue = false;
+    psParser->bKeyTruncated = false;
+    psParser->bValueTruncated = false;
+    psParser->ui32KeyLen = 0;
+    psParser->ui32ValueLen = 0;
+}
+
+//*****************************************************************************
+//
+// Parse the next ui32Len bytes of the body.  The chunk boundaries don't need
+// to line up with the fields.  Each complete field is passed to the handler
+// as soon as its terminating '&' is seen.
+//
+//*****************************************************************************
+void
+FormParserInput(tFormParser *psParser, const char *pcBuf, uint32_t ui32Len)
+{
+    char cChar;
+
+    while(ui32Len--)
+    {
+        cChar = *pcBuf++;
+
+        if(cChar == '&')
+        {
+            //
+            // End of the field.
+            //
+            FormParserDispatch(psParser);
+        }
+        else if(psParser->bInValue)
+        {
+            //
+            // Part of the value.  Leave room for the terminating 0.
+            //
+            if(psParser->ui32ValueLen < (FORM_VALUE_SIZE - 1))
+            {
+                psParser->pcValue[psParser->ui32ValueLen++] = cChar;
+            }
+            else
+            {
+                psParser->bValueTruncated = true;
+            }
+        }
+        else if(cChar == '=')
+        {
+            //
+            // End of the key.
+            //
+            psParser->bInValue = true;
+        }
+        else
+        {
+            //
+            // Part of the key.  Leave room for the terminating 0.
+            //
+            if(psParser->ui32KeyLen < (FORM_KEY_SIZE - 1))
+            {
+                psParser->pcKey[psParser->ui32KeyLen++] = cChar;
+            }
+            else
+            {
+                psParser->bKeyTruncated = true;
+            }
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Signal the end of the body.  The last field is not followed by '&', so it
+// is passed to the handler here.
+//
+//*****************************************************************************
+void
+FormParserEnd(tFormParser *psParser)
+{
+    FormParserDispatch(psParser);
+}
@@ -0,0 +1,93 @@
+//*****************************************************************************
+//
+// form_parser.h - Incremental parser for form-urlencoded response bodies.
+//
+// Copyright (c) 2015 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+//
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+//
+//*****************************************************************************
+
+
+#ifndef __FORM_PARSER_H__
+#define __FORM_PARSER_H__
+
+//*****************************************************************************
+//
+// Labels that define the longest key and value that the parser passes to the
+// field handler, including the terminating 0.  Longer values are truncated.
+// The limits apply to the key and value as received, before URL decoding.
+//
+//*****************************************************************************
+#define FORM_KEY_SIZE           16
+#define FORM_VALUE_SIZE         128
+
+//*****************************************************************************
+//
+// Function called by the parser for each <key>=<value> field.  Both strings
+// are URL decoded, 0 terminated and only valid for the duration of the call.
+// bTruncated is set if the value did not fit in FORM_VALUE_SIZE.
+//
+//*****************************************************************************
+typedef void (*tFormFieldHandler)(const char *pcKey, const char *pcValue,
+                                  bool bTruncated);
+
+//*****************************************************************************
+//
+// Parser state.  This is kept between calls to FormParserInput(), so a body
+// can be fed to the parser in chunks of any size without having to hold the
+// whole body in memory.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // Function that the parsed fields are passed to.
+    //
+    tFormFieldHandler pfnHandler;
+
+    //
+    // True while parsing a value, false while parsing a key.
+    //
+    bool bInValue;
+
+    //
+    // Set if the current key or value did not fit in its buffer.
+    //
+    bool bKeyTruncated;
+    bool bValueTruncated;
+
+    //
+    // Length and contents of the current key and value.
+    //
+    uint32_t ui32KeyLen;
+    uint32_t ui32ValueLen;
+    char pcKey[FORM_KEY_SIZE];
+    char pcValue[FORM_VALUE_SIZE];
+} tFormParser;
+
+//*****************************************************************************
+//
+// Prototypes of the functions that are called from outside the form_parser.c
+// module.
+//
+//*****************************************************************************
+extern void FormParserInit(tFormParser *psParser,
+                           tFormFieldHandler pfnHandler);
+extern void FormParserInput(tFormParser *psParser, const char *pcBuf,
+                            uint32_t ui32Len);
+extern void FormParserEnd(tFormParser *psParser);
+
+#endif // __FORM_PARSER_H__
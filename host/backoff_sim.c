@@ -0,0 +1,264 @@
+//*****************************************************************************
+//
+// backoff_sim.c - Host simulation of a fleet reconnecting after an outage.
+//
+// Copyright (c) 2015 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+//
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+//
+//*****************************************************************************
+
+
+
+//*****************************************************************************
+//
+// Simulates BOARDS boards that all lose the server at the same time, as in a
+// server outage, and reconnect once it is back.  The server accepts
+// SERVER_RATE connections per second, with bursts of up to one second worth
+// of connections, and an attempt beyond that fails like one made during the
+// outage.  Two retry policies are compared:
+//
+// - "fixed", as the Cloud task retried before backoff.c: every second, with
+//   a 10 second pause after every 5 failures in a row.
+// - "backoff", backoff.c with the connect policy of the Cloud task.
+//
+// Build and run on the host from this directory with:
+//
+//   gcc -O2 -I. -I.. -o backoff_sim backoff_sim.c ../backoff.c
+//       && ./backoff_sim
+//
+// All boards draw their jitter from the one generator of backoff.c, which
+// stands in for the boards each having a generator seeded differently.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "backoff.h"
+
+//*****************************************************************************
+//
+// The fleet, the outage and the server.  Times are in milliseconds and the
+// simulation advances in steps of TICK_MS.
+//
+//*****************************************************************************
+#define BOARDS                  10000
+#define OUTAGE_MS               60000
+#define SERVER_RATE             200
+#define TICK_MS                 10
+#define SIM_MS                  1800000
+#define REPORT_MS               10000
+#define REPORT_PERIODS          30
+
+//*****************************************************************************
+//
+// The retry policies, as in cloud_task.c.
+//
+//*****************************************************************************
+#define FIXED_RETRY_MS          1000
+#define FIXED_RETRIES           5
+#define FIXED_PAUSE_MS          10000
+#define CONNECT_BACKOFF_BASE    1000
+#define CONNECT_BACKOFF_CAP     120000
+
+//*****************************************************************************
+//
+// State of each board.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32NextMs;
+    bool bConnected;
+    tBackoff sBackoff;
+} tBoard;
+
+static tBoard g_psBoards[BOARDS];
+
+//*****************************************************************************
+//
+// Number of attempts made in each REPORT_MS period.
+//
+//*****************************************************************************
+static uint32_t g_pui32Attempts[SIM_MS / REPORT_MS];
+
+//*****************************************************************************
+//
+// Returns the delay before the next attempt of a board whose attempt failed.
+//
+//*****************************************************************************
+static uint32_t
+RetryDelay(tBoard *psBoard, bool bBackoff)
+{
+    if(bBackoff)
+    {
+        return (BackoffNext(&psBoard->sBackoff));
+    }
+
+    psBoard->sBackoff.ui32Failures++;
+    if((psBoard->sBackoff.ui32Failures % FIXED_RETRIES) == 0)
+    {
+        return (FIXED_PAUSE_MS);
+    }
+
+    return (FIXED_RETRY_MS);
+}
+
+//*****************************************************************************
+//
+// Runs the simulation with one policy and prints the results.
+//
+//*****************************************************************************
+static void
+Simulate(bool bBackoff)
+{
+    uint32_t ui32Ms, ui32Idx, ui32Connected, ui32Total;
+    uint32_t ui32Peak, ui32PeakMs, ui32Second, ui32HalfMs, ui32AllMs;
+    uint32_t ui32Credit;
+
+    memset(g_psBoards, 0, sizeof(g_psBoards));
+    memset(g_pui32Attempts, 0, sizeof(g_pui32Attempts));
+    BackoffSeed(0x2545F491);
+    for(ui32Idx = 0; ui32Idx < BOARDS; ui32Idx++)
+    {
+        BackoffConfig(&g_psBoards[ui32Idx].sBackoff, CONNECT_BACKOFF_BASE,
+                      CONNECT_BACKOFF_CAP);
+    }
+
+    ui32Connected = 0;
+    ui32Total = 0;
+    ui32Peak = 0;
+    ui32PeakMs = 0;
+    ui32Second = 0;
+    ui32HalfMs = 0;
+    ui32AllMs = 0;
+    ui32Credit = 0;
+    for(ui32Ms = 0; (ui32Ms < SIM_MS) && (ui32Connected < BOARDS);
+        ui32Ms += TICK_MS)
+    {
+        //
+        // Once the outage is over, the server earns the right to take one
+        // more connection every 1000 / SERVER_RATE ms, up to SERVER_RATE.
+        //
+        if(ui32Ms >= OUTAGE_MS)
+        {
+            ui32Credit += SERVER_RATE * TICK_MS;
+            if(ui32Credit > (SERVER_RATE * 1000))
+            {
+                ui32Credit = SERVER_RATE * 1000;
+            }
+        }
+
+        for(ui32Idx = 0; ui32Idx < BOARDS; ui32Idx++)
+        {
+            tBoard *psBoard = &g_psBoards[ui32Idx];
+
+            if(psBoard->bConnected || (psBoard->ui32NextMs > ui32Ms))
+            {
+                continue;
+            }
+
+            g_pui32Attempts[ui32Ms / REPORT_MS]++;
+            ui32Total++;
+            ui32Second++;
+            if(ui32Credit >= 1000)
+            {
+                ui32Credit -= 1000;
+                psBoard->bConnected = true;
+                ui32Connected++;
+            }
+            else
+            {
+                psBoard->ui32NextMs = ui32Ms + RetryDelay(psBoard, bBackoff);
+            }
+        }
+
+        if(((ui32Ms + TICK_MS) % 1000) == 0)
+        {
+            if((ui32Ms >= OUTAGE_MS) && (ui32Second > ui32Peak))
+            {
+                ui32Peak = ui32Second;
+                ui32PeakMs = ui32Ms - OUTAGE_MS;
+            }
+            ui32Second = 0;
+        }
+
+        if((ui32HalfMs == 0) && (ui32Connected >= (BOARDS / 2)))
+        {
+            ui32HalfMs = ui32Ms;
+        }
+        if(ui32Connected == BOARDS)
+        {
+            ui32AllMs = ui32Ms;
+        }
+    }
+
+    printf("%s policy:\n", bBackoff ? "Backoff" : "Fixed");
+    printf("  attempts per second after the outage, peak %u at +%u s\n",
+           ui32Peak, ui32PeakMs / 1000);
+    printf("  half reconnected at ");
+    if(ui32HalfMs)
+    {
+        printf("+%u s, ", (ui32HalfMs - OUTAGE_MS) / 1000);
+    }
+    else
+    {
+        printf("never, ");
+    }
+    printf("all at ");
+    if(ui32AllMs)
+    {
+        printf("+%u s\n", (ui32AllMs - OUTAGE_MS) / 1000);
+    }
+    else
+    {
+        printf("never (%u left)\n", BOARDS - ui32Connected);
+    }
+    printf("  attempts %u, %.2f per board\n", ui32Total,
+           (double)ui32Total / BOARDS);
+    printf("  attempts per %u s, the outage ending at the '|':\n   ",
+           REPORT_MS / 1000);
+    for(ui32Idx = 0; ui32Idx < REPORT_PERIODS; ui32Idx++)
+    {
+        if(ui32Idx == (OUTAGE_MS / REPORT_MS))
+        {
+            printf(" |");
+        }
+        printf(" %u", g_pui32Attempts[ui32Idx]);
+        if((ui32Idx % 10) == 9)
+        {
+            printf("\n%s", (ui32Idx < (REPORT_PERIODS - 1)) ? "   " : "");
+        }
+    }
+    printf("\n");
+}
+
+//*****************************************************************************
+//
+// Run the simulation with both policies.
+//
+//*****************************************************************************
+int
+main(void)
+{
+    printf("%u boards, %u s outage, server takes %u connections/s.\n\n",
+           BOARDS, OUTAGE_MS / 1000, SERVER_RATE);
+    Simulate(false);
+    Simulate(true);
+
+    return (0);
+}
@@ -0,0 +1,58 @@
+//*****************************************************************************
+//
+// cycles.h - Cycle counter for the host benchmarks.
+//
+// Copyright (c) 2015 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+//
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+//
+//*****************************************************************************
+
+
+#ifndef __CYCLES_H__
+#define __CYCLES_H__
+
+//*****************************************************************************
+//
+// The host benchmarks count time in cycles of the time stamp counter on x86
+// hosts, and in nanoseconds elsewhere.  Either way, only the ratios between
+// the old and the new code are meaningful, not the absolute numbers, which
+// differ from those of the Cortex-M4.
+//
+//*****************************************************************************
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CYCLES_UNIT             "cycles"
+
+static inline uint64_t
+CyclesGet(void)
+{
+    return (__rdtsc());
+}
+#else
+#include <time.h>
+#define CYCLES_UNIT             "ns"
+
+static inline uint64_t
+CyclesGet(void)
+{
+    struct timespec sTime;
+
+    clock_gettime(CLOCK_MONOTONIC, &sTime);
+    return (((uint64_t)sTime.tv_sec * 1000000000) + sTime.tv_nsec);
+}
+#endif
+
+#endif // __CYCLES_H__
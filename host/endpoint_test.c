@@ -0,0 +1,316 @@
+//*****************************************************************************
+//
+// endpoint_test.c - Host test of the endpoint failover.
+//
+// Copyright (c) 2015 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+//
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+//
+//*****************************************************************************
+
+
+
+//*****************************************************************************
+//
+// Tests endpoint.c with the failover loop of ServerConnect() in cloud_task.c
+// against stand-in endpoints that are dead, slow or fast.  Build and run on
+// the host from this directory with:
+//
+//   gcc -O2 -I.. -o endpoint_test endpoint_test.c ../endpoint.c
+//       && ./endpoint_test
+//
+// It prints each failed check and returns the number of failed checks.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "endpoint.h"
+
+//*****************************************************************************
+//
+// The endpoints, as in cloud_task.c, and the hold time of a demoted one.
+// One clock tick is one millisecond.
+//
+//*****************************************************************************
+#define ENDPOINT_DIRECT         0
+#define ENDPOINT_PROXY          1
+#define ENDPOINT_ALTERNATE      2
+#define NUM_ENDPOINTS           3
+#define ENDPOINT_HOLD_MS        30000
+
+static tEndpoint g_psEndpoints[NUM_ENDPOINTS];
+
+//*****************************************************************************
+//
+// How each stand-in endpoint answers: the time a connect takes, and whether
+// it fails after that time.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32ConnectMs;
+    bool bDead;
+} tStandIn;
+
+static tStandIn g_psStandIns[NUM_ENDPOINTS];
+
+//*****************************************************************************
+//
+// The clock, the number of connects made to each endpoint and the number of
+// failed checks.
+//
+//*****************************************************************************
+static uint32_t g_ui32Ticks;
+static uint32_t g_pui32Attempts[NUM_ENDPOINTS];
+static uint32_t g_ui32Failed;
+
+#define CHECK(test)                                                           \
+    do                                                                        \
+    {                                                                         \
+        if(!(test))                                                           \
+        {                                                                     \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #test);   \
+            g_ui32Failed++;                                                   \
+        }                                                                     \
+    } while(0)
+
+//*****************************************************************************
+//
+// Configures the endpoints and the stand-ins, and starts the clock at
+// ui32Ticks.
+//
+//*****************************************************************************
+static void
+Setup(uint32_t ui32Ticks, bool bAlternate)
+{
+    static const char * const ppcNames[NUM_ENDPOINTS] =
+    {
+        "direct",
+        "proxy",
+        "alternate"
+    };
+    uint32_t ui32Idx;
+
+    memset(g_psEndpoints, 0, sizeof(g_psEndpoints));
+    memset(g_psStandIns, 0, sizeof(g_psStandIns));
+    memset(g_pui32Attempts, 0, sizeof(g_pui32Attempts));
+    for(ui32Idx = 0; ui32Idx < NUM_ENDPOINTS; ui32Idx++)
+    {
+        g_psEndpoints[ui32Idx].pcName = ppcNames[ui32Idx];
+        g_psStandIns[ui32Idx].ui32ConnectMs = 100;
+    }
+    g_psEndpoints[ENDPOINT_PROXY].bProxy = true;
+
+    EndpointSet(&g_psEndpoints[ENDPOINT_DIRECT], "m2.exosite.com:443");
+    EndpointSet(&g_psEndpoints[ENDPOINT_PROXY], "192.168.1.80:80");
+    EndpointSet(&g_psEndpoints[ENDPOINT_ALTERNATE],
+                bAlternate ? "m3.exosite.com:443" : "");
+
+    g_ui32Ticks = ui32Ticks;
+}
+
+//*****************************************************************************
+//
+// Connects like ServerConnect() does.  Returns the index of the endpoint
+// that was connected, or -1 if all of them failed.
+//
+//*****************************************************************************
+static int32_t
+Connect(void)
+{
+    uint32_t ui32Tried;
+    int32_t i32Idx;
+
+    ui32Tried = 0;
+    while(1)
+    {
+        i32Idx = EndpointSelect(g_psEndpoints, NUM_ENDPOINTS, ui32Tried,
+                                g_ui32Ticks);
+        if(i32Idx < 0)
+        {
+            return (-1);
+        }
+        ui32Tried |= (1 << i32Idx);
+
+        g_pui32Attempts[i32Idx]++;
+        g_ui32Ticks += g_psStandIns[i32Idx].ui32ConnectMs;
+        if(!g_psStandIns[i32Idx].bDead)
+        {
+            EndpointSuccess(&g_psEndpoints[i32Idx],
+                            g_psStandIns[i32Idx].ui32ConnectMs);
+            return (i32Idx);
+        }
+
+        EndpointFailure(&g_psEndpoints[i32Idx], g_ui32Ticks,
+                        ENDPOINT_HOLD_MS);
+    }
+}
+
+//*****************************************************************************
+//
+// A dead endpoint is failed over within one connect, and is then held off
+// until its hold time is over.
+//
+//*****************************************************************************
+static void
+TestDeadEndpoint(uint32_t ui32Start)
+{
+    uint32_t ui32Idx;
+
+    Setup(ui32Start, true);
+    g_psStandIns[ENDPOINT_DIRECT].bDead = true;
+    g_psStandIns[ENDPOINT_DIRECT].ui32ConnectMs = 10000;
+
+    //
+    // All endpoints are unknown, so the direct one is tried first, and the
+    // connect moves on to the next one in the list.
+    //
+    CHECK(Connect() == ENDPOINT_PROXY);
+    CHECK(g_pui32Attempts[ENDPOINT_DIRECT] == 1);
+
+    //
+    // The proxy is now known to work and is kept.
+    //
+    for(ui32Idx = 0; ui32Idx < 10; ui32Idx++)
+    {
+        g_ui32Ticks += 1000;
+        CHECK(Connect() == ENDPOINT_PROXY);
+    }
+    CHECK(g_pui32Attempts[ENDPOINT_DIRECT] == 1);
+    CHECK(g_pui32Attempts[ENDPOINT_ALTERNATE] == 0);
+}
+
+//*****************************************************************************
+//
+// When the endpoint in use dies, the connect moves on to the next one, and
+// the error rate of the dead one keeps it from being tried first while
+// another endpoint works.  It wins again once it works and its error rate
+// decayed.
+//
+//*****************************************************************************
+static void
+TestFailover(uint32_t ui32Start)
+{
+    uint32_t ui32Idx;
+
+    Setup(ui32Start, true);
+    g_psStandIns[ENDPOINT_PROXY].ui32ConnectMs = 800;
+    CHECK(Connect() == ENDPOINT_DIRECT);
+
+    //
+    // The direct route dies.  The next connect moves on to the proxy, and
+    // the ones after it start there.
+    //
+    g_psStandIns[ENDPOINT_DIRECT].bDead = true;
+    g_psStandIns[ENDPOINT_DIRECT].ui32ConnectMs = 10000;
+    CHECK(Connect() == ENDPOINT_PROXY);
+    CHECK(g_pui32Attempts[ENDPOINT_DIRECT] == 2);
+    for(ui32Idx = 0; ui32Idx < 10; ui32Idx++)
+    {
+        g_ui32Ticks += 1000;
+        CHECK(Connect() == ENDPOINT_PROXY);
+    }
+    CHECK(g_pui32Attempts[ENDPOINT_DIRECT] == 2);
+
+    //
+    // The proxy dies too.  The alternate, which was never tried, is scored
+    // better than the direct route with its errors.
+    //
+    g_psStandIns[ENDPOINT_PROXY].bDead = true;
+    CHECK(Connect() == ENDPOINT_ALTERNATE);
+    CHECK(g_pui32Attempts[ENDPOINT_DIRECT] == 2);
+
+    //
+    // Once the direct route is back, each success decays its error rate
+    // until it is scored as well as the alternate, which it then wins over
+    // by coming first.
+    //
+    g_psStandIns[ENDPOINT_DIRECT].bDead = false;
+    g_psStandIns[ENDPOINT_DIRECT].ui32ConnectMs = 100;
+    for(ui32Idx = 0; ui32Idx < 30; ui32Idx++)
+    {
+        EndpointSuccess(&g_psEndpoints[ENDPOINT_DIRECT], 100);
+    }
+    CHECK(g_psEndpoints[ENDPOINT_DIRECT].ui32Failures == 0);
+    CHECK(Connect() == ENDPOINT_DIRECT);
+}
+
+//*****************************************************************************
+//
+// When every endpoint is dead, a connect tries each configured one once and
+// fails.  They are demoted after ENDPOINT_DEMOTE_FAILURES failures, but a
+// connect is still attempted once all of them are.  An endpoint without an
+// address is never tried.
+//
+//*****************************************************************************
+static void
+TestAllDead(uint32_t ui32Start)
+{
+    uint32_t ui32Idx;
+
+    Setup(ui32Start, false);
+    g_psStandIns[ENDPOINT_DIRECT].bDead = true;
+    g_psStandIns[ENDPOINT_PROXY].bDead = true;
+
+    CHECK(Connect() == -1);
+    CHECK(g_pui32Attempts[ENDPOINT_DIRECT] == 1);
+    CHECK(g_pui32Attempts[ENDPOINT_PROXY] == 1);
+
+    for(ui32Idx = 0; ui32Idx < 5; ui32Idx++)
+    {
+        CHECK(Connect() == -1);
+    }
+    CHECK(g_pui32Attempts[ENDPOINT_ALTERNATE] == 0);
+    CHECK(!EndpointHealthy(&g_psEndpoints[ENDPOINT_DIRECT], g_ui32Ticks));
+    CHECK(!EndpointHealthy(&g_psEndpoints[ENDPOINT_PROXY], g_ui32Ticks));
+    CHECK(EndpointSelect(g_psEndpoints, NUM_ENDPOINTS, 0, g_ui32Ticks) >= 0);
+
+    //
+    // The hold time grows with the failures, up to ENDPOINT_HOLD_STEPS
+    // times the hold time.
+    //
+    CHECK((g_psEndpoints[ENDPOINT_DIRECT].ui32HoldTicks - g_ui32Ticks) <=
+          (ENDPOINT_HOLD_STEPS * ENDPOINT_HOLD_MS));
+    CHECK((g_psEndpoints[ENDPOINT_DIRECT].ui32HoldTicks - g_ui32Ticks) >
+          ENDPOINT_HOLD_MS);
+}
+
+//*****************************************************************************
+//
+// Run the tests, with the clock also starting just before it wraps.
+//
+//*****************************************************************************
+int
+main(void)
+{
+    static const uint32_t pui32Starts[] = { 0, 0xFFFFFFFF - 20000 };
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < (sizeof(pui32Starts) / sizeof(uint32_t));
+        ui32Idx++)
+    {
+        TestDeadEndpoint(pui32Starts[ui32Idx]);
+        TestFailover(pui32Starts[ui32Idx]);
+        TestAllDead(pui32Starts[ui32Idx]);
+    }
+
+    printf("Endpoint failover: %s (%u checks failed).\n",
+           (g_ui32Failed ? "FAILED" : "passed"), g_ui32Failed);
+
+    return (g_ui32Failed);
+}
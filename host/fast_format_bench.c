@@ -0,0 +1,250 @@
+//*****************************************************************************
+//
+// fast_format_bench.c - Host benchmark of the request field formatter.
+//
+// Copyright (c) 2015 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+//
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+//
+//*****************************************************************************
+
+
+
+//*****************************************************************************
+//
+// Compares the request fields formatted by fast_format.c with the snprintf()
+// calls that WriteRequestBody() and WriteRecordBody() made before it.  Build
+// and run on the host from this directory with:
+//
+//   gcc -O2 -I.. -o fast_format_bench fast_format_bench.c ../fast_format.c
+//       ../url_codec.c && ./fast_format_bench
+//
+// Both versions format the fields into a small buffer and copy them to the
+// request body, as EmitRequestBody() does with the send buffer.  The time
+// of the old version is that of the host C library's snprintf(), not of the
+// one in the TI compiler runtime.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "cycles.h"
+#include "fast_format.h"
+
+//*****************************************************************************
+//
+// Number of times each body is formatted.
+//
+//*****************************************************************************
+#define BENCH_ROUNDS            200000
+
+//*****************************************************************************
+//
+// The numeric aliases of a POST body, as written after the board state
+// changed, and whether they are written in hex.
+//
+//*****************************************************************************
+typedef struct
+{
+    const char *pcName;
+    bool bHex;
+    uint32_t ui32Value;
+} tBenchAlias;
+
+static const tBenchAlias g_psBenchAliases[] =
+{
+    { "usrsw1", false, 0 },
+    { "usrsw2", false, 1 },
+    { "jtemp", false, 2873 },
+    { "ontime", false, 421137 },
+    { "gamestate", true, 0x5400 },
+    { "ledd1", false, 1 },
+    { "syncperiod", false, 1000 },
+    { "syncmask", true, 0xfff }
+};
+
+#define NUM_BENCH_ALIASES                                                     \
+    (sizeof(g_psBenchAliases) / sizeof(g_psBenchAliases[0]))
+
+//*****************************************************************************
+//
+// Number of samples of a record body, and the request body the fields are
+// copied to.
+//
+//*****************************************************************************
+#define BENCH_SAMPLES           16
+
+static char g_pcBody[1024];
+static uint32_t g_ui32BodyLen;
+
+static void
+BodyAppend(const char *pcField, uint32_t ui32Len)
+{
+    memcpy(g_pcBody + g_ui32BodyLen, pcField, ui32Len);
+    g_ui32BodyLen += ui32Len;
+}
+
+//*****************************************************************************
+//
+// The POST body, formatted as WriteRequestBody() did before and does now.
+//
+//*****************************************************************************
+static void
+OldRequestBody(void)
+{
+    char pcField[64];
+    uint32_t ui32Idx;
+    int32_t i32Ret;
+
+    g_ui32BodyLen = 0;
+    for(ui32Idx = 0; ui32Idx < NUM_BENCH_ALIASES; ui32Idx++)
+    {
+        i32Ret = snprintf(pcField, sizeof(pcField),
+                          (g_psBenchAliases[ui32Idx].bHex ? "%s%s=0x%x" :
+                           "%s%s=%u"), (g_ui32BodyLen ? "&" : ""),
+                          g_psBenchAliases[ui32Idx].pcName,
+                          g_psBenchAliases[ui32Idx].ui32Value);
+        BodyAppend(pcField, i32Ret);
+    }
+}
+
+static void
+NewRequestBody(void)
+{
+    tFormatCursor sCursor;
+    char pcField[32];
+    uint32_t ui32Idx;
+
+    g_ui32BodyLen = 0;
+    for(ui32Idx = 0; ui32Idx < NUM_BENCH_ALIASES; ui32Idx++)
+    {
+        FormatInit(&sCursor, pcField, sizeof(pcField));
+        if(g_ui32BodyLen)
+        {
+            FormatBytes(&sCursor, "&", 1);
+        }
+        FormatString(&sCursor, g_psBenchAliases[ui32Idx].pcName);
+        FormatBytes(&sCursor, "=", 1);
+        if(g_psBenchAliases[ui32Idx].bHex)
+        {
+            FormatHex(&sCursor, g_psBenchAliases[ui32Idx].ui32Value);
+        }
+        else
+        {
+            FormatDecimal(&sCursor, g_psBenchAliases[ui32Idx].ui32Value);
+        }
+        BodyAppend(pcField, sCursor.ui32Len);
+    }
+}
+
+//*****************************************************************************
+//
+// The samples of a record body, formatted as WriteRecordBody() did before
+// and does now.
+//
+//*****************************************************************************
+static void
+OldRecordBody(void)
+{
+    char pcField[96];
+    uint32_t ui32Index;
+    int32_t i32Ret;
+
+    g_ui32BodyLen = 0;
+    for(ui32Index = 0; ui32Index < BENCH_SAMPLES; ui32Index++)
+    {
+        i32Ret = snprintf(pcField, sizeof(pcField), "%s[%u,%u]",
+                          (ui32Index ? "," : ""), 1476601200 + ui32Index,
+                          2800 + ui32Index);
+        BodyAppend(pcField, i32Ret);
+    }
+}
+
+static void
+NewRecordBody(void)
+{
+    tFormatCursor sCursor;
+    char pcField[96];
+    uint32_t ui32Index;
+
+    g_ui32BodyLen = 0;
+    for(ui32Index = 0; ui32Index < BENCH_SAMPLES; ui32Index++)
+    {
+        FormatInit(&sCursor, pcField, sizeof(pcField));
+        FormatString(&sCursor, (ui32Index ? ",[" : "["));
+        FormatDecimal(&sCursor, 1476601200 + ui32Index);
+        FormatBytes(&sCursor, ",", 1);
+        FormatDecimal(&sCursor, 2800 + ui32Index);
+        FormatBytes(&sCursor, "]", 1);
+        BodyAppend(pcField, sCursor.ui32Len);
+    }
+}
+
+//*****************************************************************************
+//
+// Times both versions of a body, checks that they produce the same text and
+// prints the time per body.
+//
+//*****************************************************************************
+static void
+BenchBody(const char *pcName, void (*pfnOld)(void), void (*pfnNew)(void))
+{
+    static char pcOld[sizeof(g_pcBody)];
+    uint64_t ui64Start, ui64Old, ui64New;
+    uint32_t ui32Round, ui32OldLen;
+
+    ui64Start = CyclesGet();
+    for(ui32Round = 0; ui32Round < BENCH_ROUNDS; ui32Round++)
+    {
+        pfnOld();
+    }
+    ui64Old = (CyclesGet() - ui64Start) / BENCH_ROUNDS;
+    ui32OldLen = g_ui32BodyLen;
+    memcpy(pcOld, g_pcBody, ui32OldLen);
+
+    ui64Start = CyclesGet();
+    for(ui32Round = 0; ui32Round < BENCH_ROUNDS; ui32Round++)
+    {
+        pfnNew();
+    }
+    ui64New = (CyclesGet() - ui64Start) / BENCH_ROUNDS;
+
+    printf("%-14s %6u  %10llu  %10llu  %6.2fx  %s\n", pcName, ui32OldLen,
+           (unsigned long long)ui64Old, (unsigned long long)ui64New,
+           (double)ui64Old / ui64New,
+           (((ui32OldLen == g_ui32BodyLen) &&
+             (memcmp(pcOld, g_pcBody, ui32OldLen) == 0)) ? "same" :
+            "DIFFERENT"));
+}
+
+//*****************************************************************************
+//
+// Run the benchmark on both bodies.
+//
+//*****************************************************************************
+int
+main(void)
+{
+    printf("Request body formatting, %u rounds per body, time per body in "
+           "%s.\n", BENCH_ROUNDS, CYCLES_UNIT);
+    printf("%-14s %6s  %10s  %10s  %7s  %s\n", "body", "bytes", "snprintf",
+           "cursor", "speedup", "output");
+    BenchBody("POST aliases", OldRequestBody, NewRequestBody);
+    BenchBody("16 samples", OldRecordBody, NewRecordBody);
+
+    return (0);
+}
@@ -0,0 +1,286 @@
+//*****************************************************************************
+//
+// form_parser_bench.c - Host benchmark of the response body parser.
+//
+// Copyright (c) 2015 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+//
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+//
+//*****************************************************************************
+
+
+//*****************************************************************************
+//
+// Compares the incremental form parser in form_parser.c with the strstr()
+// based parser that ProcessResponseBody() used before it.  Build and run on
+// the host from this directory with:
+//
+//   gcc -O2 -I.. -o form_parser_bench form_parser_bench.c ../form_parser.c
+//       ../url_codec.c && ./form_parser_bench
+//
+// The old parser is given the whole body in one buffer, which is the best
+// case for it, as on the board it only ever saw the last chunk.  The new
+// parser is fed the body in 128 byte chunks, as ProcessResponseBody() reads
+// it.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cycles.h"
+#include "form_parser.h"
+
+//*****************************************************************************
+//
+// Number of times each body is parsed, and the size of the chunks the new
+// parser is fed.
+//
+//*****************************************************************************
+#define BENCH_ROUNDS            20000
+#define BENCH_CHUNK             128
+
+//*****************************************************************************
+//
+// The aliases and value buffer size of the old parser.
+//
+//*****************************************************************************
+#define ALIAS_PROCESSING        3
+#define VALUEBUF_SIZE           40
+
+static const char g_ppcGETAlias[ALIAS_PROCESSING][15] =
+{
+    "ledd1",
+    "emailaddr",
+    "gamestate"
+};
+
+//*****************************************************************************
+//
+// Where both parsers store the values, standing in for the alias storage.
+//
+//*****************************************************************************
+static uint32_t g_ui32LEDD1;
+static uint32_t g_ui32BoardState;
+static char g_pcEmail[100];
+static char g_pcLocation[100];
+
+//*****************************************************************************
+//
+// The old parser, as it was in cloud_task.c.
+//
+//*****************************************************************************
+static void
+OldProcessResponseBody(char *pcBuf)
+{
+    uint32_t ui32Index, j;
+    char *pcValueStart = NULL;
+    char ppcValueBuf[ALIAS_PROCESSING][VALUEBUF_SIZE];
+
+    for(ui32Index = 0; ui32Index < ALIAS_PROCESSING; ui32Index++)
+    {
+        pcValueStart = strstr(pcBuf, g_ppcGETAlias[ui32Index]);
+        if(!pcValueStart)
+        {
+            continue;
+        }
+
+        pcValueStart = strstr(pcValueStart, "=");
+        if(!pcValueStart)
+        {
+            continue;
+        }
+        pcValueStart++;
+
+        j = 0;
+        while(j < VALUEBUF_SIZE)
+        {
+            if((pcValueStart[j] == '&') || (pcValueStart[j] == 0))
+            {
+                ppcValueBuf[ui32Index][j] = 0;
+                break;
+            }
+            else
+            {
+                ppcValueBuf[ui32Index][j] = pcValueStart[j];
+            }
+
+            j++;
+        }
+    }
+
+    g_ui32LEDD1 = (ppcValueBuf[0][0] == '1') ? 1 : 0;
+    strncpy(g_pcEmail, ppcValueBuf[1], sizeof(g_pcEmail));
+    g_pcEmail[99] = '\0';
+    g_ui32BoardState = strtoul(ppcValueBuf[2], NULL, 0);
+}
+
+//*****************************************************************************
+//
+// Field handler of the new parser, applying the values like
+// ProcessAliasValue() does.
+//
+//*****************************************************************************
+static void
+NewAliasValue(const char *pcKey, const char *pcValue, bool bTruncated)
+{
+    if(bTruncated)
+    {
+        return;
+    }
+
+    if(strcmp(pcKey, "ledd1") == 0)
+    {
+        g_ui32LEDD1 = (pcValue[0] == '1') ? 1 : 0;
+    }
+    else if(strcmp(pcKey, "emailaddr") == 0)
+    {
+        strncpy(g_pcEmail, pcValue, sizeof(g_pcEmail));
+        g_pcEmail[99] = '\0';
+    }
+    else if(strcmp(pcKey, "gamestate") == 0)
+    {
+        g_ui32BoardState = strtoul(pcValue, NULL, 0);
+    }
+    else if(strcmp(pcKey, "location") == 0)
+    {
+        strncpy(g_pcLocation, pcValue, sizeof(g_pcLocation));
+        g_pcLocation[99] = '\0';
+    }
+}
+
+//*****************************************************************************
+//
+// Builds a response body of about ui32Size bytes out of the known aliases and
+// fields of other aliases.  The known aliases come before the other fields,
+// or after them if bKnownLast is set, which is the worst case for the old
+// parser as each strstr() then scans the whole body.
+//
+//*****************************************************************************
+static uint32_t
+BuildBody(char *pcBuf, uint32_t ui32Size, bool bKnownLast)
+{
+    static const char pcKnown[] = "ledd1=1&gamestate=21504&emailaddr=someone"
+                                  "%40example.com&location=Dallas%2C%20TX";
+    uint32_t ui32Len, ui32Idx;
+
+    ui32Len = 0;
+    if(!bKnownLast)
+    {
+        ui32Len = sprintf(pcBuf, "%s&", pcKnown);
+    }
+    for(ui32Idx = 0; (ui32Len + sizeof(pcKnown) + 24) < ui32Size; ui32Idx++)
+    {
+        ui32Len += sprintf(pcBuf + ui32Len, "other%02u=%012u&",
+                           ui32Idx % 100, ui32Idx * 7919);
+    }
+    if(bKnownLast)
+    {
+        ui32Len += sprintf(pcBuf + ui32Len, "%s", pcKnown);
+    }
+    else
+    {
+        pcBuf[--ui32Len] = '\0';
+    }
+
+    return (ui32Len);
+}
+
+//*****************************************************************************
+//
+// Parse each body size of one layout with both parsers and print the time
+// taken and the bytes parsed per cycle.
+//
+//*****************************************************************************
+static void
+BenchLayout(bool bKnownLast)
+{
+    static const uint32_t pui32Sizes[] = { 128, 256, 512, 1024, 4096 };
+    static char pcBody[4096 + 64];
+    static char pcCopy[4096 + 64];
+    tFormParser sParser;
+    uint64_t ui64Start, ui64Old, ui64New;
+    uint32_t ui32Size, ui32Len, ui32Round, ui32Pos, ui32Chunk;
+
+    printf("Known aliases %s, time per body in %s.\n",
+           (bKnownLast ? "last" : "first"), CYCLES_UNIT);
+    printf("%6s  %10s %8s  %10s %8s  %7s\n", "bytes", "old", "bytes/t",
+           "new", "bytes/t", "speedup");
+
+    for(ui32Size = 0; ui32Size < (sizeof(pui32Sizes) / sizeof(uint32_t));
+        ui32Size++)
+    {
+        ui32Len = BuildBody(pcBody, pui32Sizes[ui32Size], bKnownLast);
+
+        //
+        // The old parser needs the body in a writable, 0 terminated buffer.
+        // Copy it each round, as the receive loop did.
+        //
+        ui64Start = CyclesGet();
+        for(ui32Round = 0; ui32Round < BENCH_ROUNDS; ui32Round++)
+        {
+            memcpy(pcCopy, pcBody, ui32Len + 1);
+            OldProcessResponseBody(pcCopy);
+        }
+        ui64Old = (CyclesGet() - ui64Start) / BENCH_ROUNDS;
+
+        ui64Start = CyclesGet();
+        for(ui32Round = 0; ui32Round < BENCH_ROUNDS; ui32Round++)
+        {
+            FormParserInit(&sParser, NewAliasValue);
+            for(ui32Pos = 0; ui32Pos < ui32Len; ui32Pos += ui32Chunk)
+            {
+                ui32Chunk = ui32Len - ui32Pos;
+                if(ui32Chunk > BENCH_CHUNK)
+                {
+                    ui32Chunk = BENCH_CHUNK;
+                }
+                FormParserInput(&sParser, pcBody + ui32Pos, ui32Chunk);
+            }
+            FormParserEnd(&sParser);
+        }
+        ui64New = (CyclesGet() - ui64Start) / BENCH_ROUNDS;
+
+        printf("%6u  %10llu %8.2f  %10llu %8.2f  %6.2fx\n", ui32Len,
+               (unsigned long long)ui64Old, (double)ui32Len / ui64Old,
+               (unsigned long long)ui64New, (double)ui32Len / ui64New,
+               (double)ui64Old / ui64New);
+    }
+}
+
+//*****************************************************************************
+//
+// Run the benchmark with both layouts of the body.
+//
+//*****************************************************************************
+int
+main(void)
+{
+    printf("Response body parsing, %u rounds per body.\n\n", BENCH_ROUNDS);
+    BenchLayout(false);
+    printf("\n");
+    BenchLayout(true);
+
+    //
+    // The values decoded by the new parser.  The old one neither decoded
+    // them nor read the location.
+    //
+    printf("\nNew parser: emailaddr=%s location=%s\n", g_pcEmail,
+           g_pcLocation);
+
+    return (0);
+}
@@ -0,0 +1,270 @@
+//*****************************************************************************
+//
+// request_records.c - Host count of the TLS records sent per sync.
+//
+// Copyright (c) 2015 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+//
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+//
+//*****************************************************************************
+
+
+//*****************************************************************************
+//
+// Counts the writes, and so the TLS records, that the write (POST) and read
+// (GET) requests of one Sync_Separate cycle make, and the bytes they put on
+// the wire.  Build and run on the host from this directory with:
+//
+//   gcc -O2 -I. -I.. -o request_records request_records.c ../send_buffer.c
+//       && ./request_records
+//
+// The stand-in HTTPCli below records each write instead of sending it.  Its
+// HTTPCli_sendRequest() and HTTPCli_sendField() make the same writes as the
+// TI-RTOS HTTP client: one for the request line, one per default field, one
+// per field and one more for the blank line after the last field.  Every
+// write is one TLS record.  A record is assumed to use AES-CBC with an
+// HMAC-SHA1, so it adds a 5 byte header, a 16 byte IV, a 20 byte MAC and 1
+// to 16 bytes of padding, and to go out in its own TCP segment with 40
+// bytes of TCP/IP headers, as when Nagle's algorithm doesn't hold it back.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <ti/net/http/httpcli.h>
+#include "send_buffer.h"
+
+//*****************************************************************************
+//
+// The request contents, as sent by cloud_task.c.
+//
+//*****************************************************************************
+#define EXOSITE_URI             "/onep:v1/stack/alias"
+#define EXOSITE_READ_URI        EXOSITE_URI "?ledd1&location&gamestate&"   \
+                                "emailaddr&syncperiod&syncmask"
+#define EXOSITE_HOSTNAME        "m2.exosite.com"
+#define EXOSITE_CONTENT_TYPE    "application/x-www-form-urlencoded; "        \
+                                "charset=utf-8"
+#define EXOSITE_CIK             "0123456789abcdef0123456789abcdef01234567"
+#define WRITE_BODY              "usrsw1=0&usrsw2=1&jtemp=2873&ontime=4211&" \
+                                "gamestate=0&ledd1=1"
+
+//*****************************************************************************
+//
+// Bytes that TLS and TCP/IP add to a write of ui32Len bytes.
+//
+//*****************************************************************************
+#define TLS_HEADER              5
+#define TLS_IV                  16
+#define TLS_MAC                 20
+#define TLS_BLOCK               16
+#define TCPIP_HEADERS           40
+
+static uint32_t
+WireBytes(uint32_t ui32Len)
+{
+    uint32_t ui32Record;
+
+    ui32Record = ui32Len + TLS_MAC;
+    ui32Record += TLS_BLOCK - (ui32Record % TLS_BLOCK);
+
+    return (TCPIP_HEADERS + TLS_HEADER + TLS_IV + ui32Record);
+}
+
+//*****************************************************************************
+//
+// The stand-in HTTPCli.
+//
+//*****************************************************************************
+int
+HTTPCli_sendRequestBody(HTTPCli_Handle cli, const char *pcBody, int iLen)
+{
+    (void)pcBody;
+
+    cli->ui32Writes++;
+    cli->ui32Bytes += iLen;
+    cli->ui32WireBytes += WireBytes(iLen);
+
+    return (0);
+}
+
+static void
+HostWrite(HTTPCli_Handle cli, const char *pcFormat, const char *pcArg1,
+          const char *pcArg2)
+{
+    char pcBuf[256];
+    int iLen;
+
+    iLen = snprintf(pcBuf, sizeof(pcBuf), pcFormat, pcArg1, pcArg2);
+    HTTPCli_sendRequestBody(cli, pcBuf, iLen);
+}
+
+static void
+HTTPCli_sendRequest(HTTPCli_Handle cli, const char *pcMethod,
+                    const char *pcURI, bool bMoreFlag)
+{
+    HostWrite(cli, "%s %s HTTP/1.1\r\n", pcMethod, pcURI);
+    HostWrite(cli, "%s: %s\r\n", "Host", EXOSITE_HOSTNAME);
+    if(!bMoreFlag)
+    {
+        HostWrite(cli, "\r\n", NULL, NULL);
+    }
+}
+
+static void
+HTTPCli_sendField(HTTPCli_Handle cli, const char *pcName,
+                  const char *pcValue, bool bLastFlag)
+{
+    HostWrite(cli, "%s: %s\r\n", pcName, pcValue);
+    if(bLastFlag)
+    {
+        HostWrite(cli, "\r\n", NULL, NULL);
+    }
+}
+
+//*****************************************************************************
+//
+// The write and read requests as they were sent before the header block, one
+// HTTPCli call per header.
+//
+//*****************************************************************************
+static void
+FieldsSync(HTTPCli_Handle cli)
+{
+    char pcLen[12];
+
+    snprintf(pcLen, sizeof(pcLen), "%u", (unsigned)strlen(WRITE_BODY));
+    HTTPCli_sendRequest(cli, "POST", EXOSITE_URI, true);
+    HTTPCli_sendField(cli, "X-Exosite-CIK", EXOSITE_CIK, false);
+    HTTPCli_sendField(cli, "Content-Type", EXOSITE_CONTENT_TYPE, false);
+    HTTPCli_sendField(cli, "Content-Length", pcLen, true);
+    HTTPCli_sendRequestBody(cli, WRITE_BODY, strlen(WRITE_BODY));
+
+    HTTPCli_sendRequest(cli, "GET", EXOSITE_READ_URI, true);
+    HTTPCli_sendField(cli, "X-Exosite-CIK", EXOSITE_CIK, false);
+    HTTPCli_sendField(cli, "Accept", EXOSITE_CONTENT_TYPE, true);
+}
+
+//*****************************************************************************
+//
+// Builds the cached header block like SendHeaderBlock() does.  The first
+// *pui32ReadLen bytes are the headers of a read, all *pui32WriteLen bytes
+// those of a write.
+//
+//*****************************************************************************
+static void
+BuildHeaderBlock(char *pcBlock, uint32_t ui32Size, uint32_t *pui32ReadLen,
+                 uint32_t *pui32WriteLen)
+{
+    *pui32ReadLen = snprintf(pcBlock, ui32Size, "%s: %s\r\n%s: %s\r\n",
+                             "X-Exosite-CIK", EXOSITE_CIK, "Accept",
+                             EXOSITE_CONTENT_TYPE);
+    *pui32WriteLen = *pui32ReadLen + snprintf(pcBlock + *pui32ReadLen,
+                                              ui32Size - *pui32ReadLen,
+                                              "%s: %s\r\n", "Content-Type",
+                                              EXOSITE_CONTENT_TYPE);
+}
+
+//*****************************************************************************
+//
+// The write and read requests with the header block, per-request headers and
+// blank line sent in one write, and the body in another.
+//
+//*****************************************************************************
+static void
+OneWriteSync(HTTPCli_Handle cli)
+{
+    char pcBlock[256];
+    uint32_t ui32ReadLen, ui32WriteLen;
+
+    BuildHeaderBlock(pcBlock, sizeof(pcBlock), &ui32ReadLen, &ui32WriteLen);
+
+    HTTPCli_sendRequest(cli, "POST", EXOSITE_URI, true);
+    ui32WriteLen += snprintf(pcBlock + ui32WriteLen,
+                             sizeof(pcBlock) - ui32WriteLen,
+                             "Content-Length: %u\r\n\r\n",
+                             (unsigned)strlen(WRITE_BODY));
+    HTTPCli_sendRequestBody(cli, pcBlock, ui32WriteLen);
+    HTTPCli_sendRequestBody(cli, WRITE_BODY, strlen(WRITE_BODY));
+
+    BuildHeaderBlock(pcBlock, sizeof(pcBlock), &ui32ReadLen, &ui32WriteLen);
+    HTTPCli_sendRequest(cli, "GET", EXOSITE_READ_URI, true);
+    memcpy(pcBlock + ui32ReadLen, "\r\n", 2);
+    HTTPCli_sendRequestBody(cli, pcBlock, ui32ReadLen + 2);
+}
+
+//*****************************************************************************
+//
+// The write and read requests as sent now by ExositeWriteRequest() and
+// ExositeReadRequest(), with the headers and the body collected in the send
+// buffer.
+//
+//*****************************************************************************
+static void
+BufferedSync(HTTPCli_Handle cli)
+{
+    char pcBlock[256], pcFields[32];
+    uint32_t ui32ReadLen, ui32WriteLen;
+    tSendBuffer sSend;
+
+    BuildHeaderBlock(pcBlock, sizeof(pcBlock), &ui32ReadLen, &ui32WriteLen);
+
+    HTTPCli_sendRequest(cli, "POST", EXOSITE_URI, true);
+    SendBufferInit(&sSend, cli);
+    snprintf(pcFields, sizeof(pcFields), "Content-Length: %u\r\n",
+             (unsigned)strlen(WRITE_BODY));
+    SendBufferWrite(&sSend, pcBlock, ui32WriteLen);
+    SendBufferWrite(&sSend, pcFields, strlen(pcFields));
+    SendBufferWrite(&sSend, "\r\n", 2);
+    SendBufferWrite(&sSend, WRITE_BODY, strlen(WRITE_BODY));
+    SendBufferFlush(&sSend);
+
+    HTTPCli_sendRequest(cli, "GET", EXOSITE_READ_URI, true);
+    SendBufferInit(&sSend, cli);
+    SendBufferWrite(&sSend, pcBlock, ui32ReadLen);
+    SendBufferWrite(&sSend, "\r\n", 2);
+    SendBufferFlush(&sSend);
+}
+
+//*****************************************************************************
+//
+// Print the counts of one way of sending the requests.
+//
+//*****************************************************************************
+static void
+PrintSync(const char *pcName, void (*pfnSync)(HTTPCli_Handle))
+{
+    HTTPCli_Struct sCli;
+
+    memset(&sCli, 0, sizeof(sCli));
+    pfnSync(&sCli);
+    printf("%-36s %7u %7u %7u\n", pcName, sCli.ui32Writes, sCli.ui32Bytes,
+           sCli.ui32WireBytes);
+}
+
+int
+main(void)
+{
+    printf("One Sync_Separate cycle (POST + GET).\n");
+    printf("%-36s %7s %7s %7s\n", "", "records", "bytes", "on-wire");
+
+    PrintSync("one HTTPCli call per header", FieldsSync);
+    PrintSync("header block in one write", OneWriteSync);
+    PrintSync("header block and body buffered", BufferedSync);
+
+    return (0);
+}
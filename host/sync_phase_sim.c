@@ -0,0 +1,256 @@
+//*****************************************************************************
+//
+// sync_phase_sim.c - Host simulation of the sync arrivals of a fleet.
+//
+// Copyright (c) 2015 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+//
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+//
+//*****************************************************************************
+
+
+
+//*****************************************************************************
+//
+// Computes when BOARDS boards powered up together reach the server.  It
+// looks at the first connect after boot, spread over STARTUP_SPREAD, and at
+// the syncs after that, which land in each SYNC_PERIOD at the phase given by
+// the MAC hash plus up to SYNC_JITTER of jitter.  Build and run on the host
+// from this directory with:
+//
+//   gcc -O2 -I.. -o sync_phase_sim sync_phase_sim.c ../backoff.c -lm
+//       && ./sync_phase_sim
+//
+// The boards get MAC addresses with the TI OUI 00:1a:b6, either numbered in
+// sequence, as boards from one production run would be, or at random.
+// DeviceHash() and the seeding of the jitter are the same as in
+// cloud_task.c.  Each is compared with the arrivals the same number of
+// boards would give if each picked its time at random, whose bucket counts
+// have a standard deviation of the square root of their mean.
+//
+//*****************************************************************************
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "backoff.h"
+
+//*****************************************************************************
+//
+// The fleet and the sync schedule, as in cloud_task.c.  Times are in
+// milliseconds.
+//
+//*****************************************************************************
+#define BOARDS                  10000
+#define SYNC_PERIOD             1000
+#define SYNC_JITTER             50
+#define STARTUP_SPREAD          10000
+
+//*****************************************************************************
+//
+// The histograms have HIST_BUCKETS buckets, which are printed merged into
+// HIST_ROWS rows with a bar of up to HIST_BAR characters.
+//
+//*****************************************************************************
+#define HIST_BUCKETS            100
+#define HIST_ROWS               20
+#define HIST_BAR                50
+
+//*****************************************************************************
+//
+// The MAC address of the board being simulated.
+//
+//*****************************************************************************
+static char g_pcMACAddress[13];
+
+//*****************************************************************************
+//
+// Returns a hash (FNV-1a) of the MAC address, as DeviceHash() does in
+// cloud_task.c.
+//
+//*****************************************************************************
+static uint32_t
+DeviceHash(void)
+{
+    uint32_t ui32Hash = 2166136261U;
+    const char *pcChar;
+
+    for(pcChar = g_pcMACAddress; *pcChar; pcChar++)
+    {
+        ui32Hash = (ui32Hash ^ (uint8_t)*pcChar) * 16777619U;
+    }
+
+    return (ui32Hash);
+}
+
+//*****************************************************************************
+//
+// A generator for the parts of the simulation that are not done by the
+// board, kept apart from the one of backoff.c.
+//
+//*****************************************************************************
+static uint32_t g_ui32SimState = 12345;
+
+static uint32_t
+SimRandom(void)
+{
+    g_ui32SimState = (g_ui32SimState * 1103515245) + 12345;
+
+    return (g_ui32SimState >> 8);
+}
+
+//*****************************************************************************
+//
+// Prints a histogram of the arrival times in pui32Bucket, each bucket being
+// ui32BucketMs long, with the statistics of the HIST_BUCKETS buckets.
+//
+//*****************************************************************************
+static void
+PrintHistogram(const char *pcTitle, const uint32_t *pui32Bucket,
+               uint32_t ui32BucketMs)
+{
+    uint32_t ui32Idx, ui32Row, ui32Sum, ui32Max, ui32Min, ui32RowMax;
+    uint32_t pui32Row[HIST_ROWS];
+    double dMean, dVar;
+
+    ui32Max = 0;
+    ui32Min = UINT32_MAX;
+    dVar = 0;
+    dMean = (double)BOARDS / HIST_BUCKETS;
+    for(ui32Idx = 0; ui32Idx < HIST_BUCKETS; ui32Idx++)
+    {
+        ui32Max = (pui32Bucket[ui32Idx] > ui32Max) ? pui32Bucket[ui32Idx] :
+                  ui32Max;
+        ui32Min = (pui32Bucket[ui32Idx] < ui32Min) ? pui32Bucket[ui32Idx] :
+                  ui32Min;
+        dVar += ((pui32Bucket[ui32Idx] - dMean) *
+                 (pui32Bucket[ui32Idx] - dMean));
+    }
+    dVar /= HIST_BUCKETS;
+
+    printf("%s\n", pcTitle);
+    printf("  per %u ms: mean %.0f, min %u, max %u, std dev %.1f (random "
+           "%.1f)\n", ui32BucketMs, dMean, ui32Min, ui32Max, sqrt(dVar),
+           sqrt(dMean));
+
+    ui32RowMax = 0;
+    for(ui32Row = 0; ui32Row < HIST_ROWS; ui32Row++)
+    {
+        ui32Sum = 0;
+        for(ui32Idx = 0; ui32Idx < (HIST_BUCKETS / HIST_ROWS); ui32Idx++)
+        {
+            ui32Sum += pui32Bucket[(ui32Row * (HIST_BUCKETS / HIST_ROWS)) +
+                                   ui32Idx];
+        }
+        pui32Row[ui32Row] = ui32Sum;
+        ui32RowMax = (ui32Sum > ui32RowMax) ? ui32Sum : ui32RowMax;
+    }
+
+    for(ui32Row = 0; ui32Row < HIST_ROWS; ui32Row++)
+    {
+        printf("  %5u ms %5u ", ui32Row * (HIST_BUCKETS / HIST_ROWS) *
+               ui32BucketMs, pui32Row[ui32Row]);
+        for(ui32Idx = 0;
+            ui32Idx < ((pui32Row[ui32Row] * HIST_BAR) + (ui32RowMax / 2)) /
+                      ui32RowMax; ui32Idx++)
+        {
+            printf("#");
+        }
+        printf("\n");
+    }
+    printf("\n");
+}
+
+//*****************************************************************************
+//
+// Simulates the fleet with sequential or random MAC addresses and prints
+// the arrival histograms.
+//
+//*****************************************************************************
+static void
+Simulate(bool bSequential)
+{
+    uint32_t pui32Startup[HIST_BUCKETS], pui32Sync[HIST_BUCKETS];
+    uint32_t pui32Fixed[HIST_BUCKETS];
+    uint32_t ui32Board, ui32NIC, ui32IPAddr, ui32Ticks, ui32Ms;
+    char pcTitle[96];
+
+    memset(pui32Startup, 0, sizeof(pui32Startup));
+    memset(pui32Sync, 0, sizeof(pui32Sync));
+    memset(pui32Fixed, 0, sizeof(pui32Fixed));
+
+    for(ui32Board = 0; ui32Board < BOARDS; ui32Board++)
+    {
+        ui32NIC = bSequential ? (0x123400 + ui32Board) :
+                  (SimRandom() & 0xFFFFFF);
+        snprintf(g_pcMACAddress, sizeof(g_pcMACAddress), "001ab6%06x",
+                 ui32NIC);
+
+        //
+        // As the Cloud task does once it has an IP address, which DHCP hands
+        // out in sequence, a few seconds after power up.
+        //
+        ui32IPAddr = 0x0A000000 + ui32Board;
+        ui32Ticks = 3000 + (SimRandom() % 500);
+        BackoffSeed(DeviceHash() ^ ui32IPAddr ^ ui32Ticks);
+        ui32Ms = (DeviceHash() + BackoffRandom()) % STARTUP_SPREAD;
+        pui32Startup[ui32Ms / (STARTUP_SPREAD / HIST_BUCKETS)]++;
+
+        //
+        // The arrival of a sync within the period, as set by SyncWait().
+        // The jitter can push it into the next period.
+        //
+        ui32Ms = ((DeviceHash() % SYNC_PERIOD) +
+                  (BackoffRandom() % SYNC_JITTER)) % SYNC_PERIOD;
+        pui32Sync[ui32Ms / (SYNC_PERIOD / HIST_BUCKETS)]++;
+
+        //
+        // The same sync without the phase, as with the fixed one second
+        // sleep after each cycle and boards that started together.
+        //
+        ui32Ms = BackoffRandom() % SYNC_JITTER;
+        pui32Fixed[ui32Ms / (SYNC_PERIOD / HIST_BUCKETS)]++;
+    }
+
+    snprintf(pcTitle, sizeof(pcTitle), "%s MAC addresses, first connect "
+             "after power up:", bSequential ? "Sequential" : "Random");
+    PrintHistogram(pcTitle, pui32Startup, STARTUP_SPREAD / HIST_BUCKETS);
+    snprintf(pcTitle, sizeof(pcTitle), "%s MAC addresses, syncs within the "
+             "period:", bSequential ? "Sequential" : "Random");
+    PrintHistogram(pcTitle, pui32Sync, SYNC_PERIOD / HIST_BUCKETS);
+    if(bSequential)
+    {
+        PrintHistogram("Without the phase, syncs within the period:",
+                       pui32Fixed, SYNC_PERIOD / HIST_BUCKETS);
+    }
+}
+
+//*****************************************************************************
+//
+// Run the simulation with both kinds of MAC address.
+//
+//*****************************************************************************
+int
+main(void)
+{
+    printf("%u boards, sync period %u ms, jitter %u ms, startup spread %u "
+           "ms.\n\n", BOARDS, SYNC_PERIOD, SYNC_JITTER, STARTUP_SPREAD);
+    Simulate(true);
+    Simulate(false);
+
+    return (0);
+}
@@ -0,0 +1,53 @@
+//*****************************************************************************
+//
+// httpcli.h - Stand-in for the TI-RTOS HTTP client on the host.
+//
+// Copyright (c) 2015 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+//
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+//
+//*****************************************************************************
+
+
+#ifndef __HOST_HTTPCLI_H__
+#define __HOST_HTTPCLI_H__
+
+//*****************************************************************************
+//
+// The parts of the TI-RTOS HTTPCli API used by the modules that the host
+// tools build.  Each tool provides the functions, which record the writes
+// instead of sending them.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // Number of writes made to the connection and the bytes written.
+    //
+    uint32_t ui32Writes;
+    uint32_t ui32Bytes;
+
+    //
+    // On-wire bytes of those writes, as TLS records in TCP segments.
+    //
+    uint32_t ui32WireBytes;
+} HTTPCli_Struct;
+
+typedef HTTPCli_Struct *HTTPCli_Handle;
+
+extern int HTTPCli_sendRequestBody(HTTPCli_Handle cli, const char *pcBody,
+                                   int iLen);
+
+#endif // __HOST_HTTPCLI_H__
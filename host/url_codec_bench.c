@@ -0,0 +1,353 @@
+//*****************************************************************************
+//
+// url_codec_bench.c - Host benchmark of the URL encoder and decoder.
+//
+// Copyright (c) 2015 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+//
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+//
+//*****************************************************************************
+
+
+
+//*****************************************************************************
+//
+// Compares the throughput of URLEncode() and URLDecode() in url_codec.c with
+// a byte at a time encoder and decoder, the encoder being the one that
+// FormatURLEncoded() used before url_codec.c.  Every byte value is also
+// round-tripped through both versions to check that they agree.  Build and
+// run on the host from this directory with:
+//
+//   gcc -O2 -I.. -o url_codec_bench url_codec_bench.c ../url_codec.c
+//       && ./url_codec_bench
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "cycles.h"
+#include "url_codec.h"
+
+//*****************************************************************************
+//
+// Number of bytes encoded and decoded per measurement, the number of times
+// each measurement is repeated to keep the fastest, and the largest input.
+//
+//*****************************************************************************
+#define BENCH_BYTES             (4 * 1024 * 1024)
+#define BENCH_REPEATS           7
+#define BENCH_MAX_SIZE          1024
+
+static const char g_pcHexDigits[] = "0123456789ABCDEF";
+
+//*****************************************************************************
+//
+// The byte at a time encoder, as FormatURLEncoded() was before url_codec.c.
+//
+//*****************************************************************************
+static uint32_t
+OldURLEncode(char *pcOut, const char *pcIn, uint32_t ui32Len)
+{
+    char *pcStart = pcOut;
+    uint8_t ui8Char;
+
+    while(ui32Len--)
+    {
+        ui8Char = (uint8_t)*pcIn++;
+        if(((ui8Char >= 'a') && (ui8Char <= 'z')) ||
+           ((ui8Char >= 'A') && (ui8Char <= 'Z')) ||
+           ((ui8Char >= '0') && (ui8Char <= '9')) ||
+           (ui8Char == '-') || (ui8Char == '.') || (ui8Char == '_') ||
+           (ui8Char == '~'))
+        {
+            *pcOut++ = ui8Char;
+        }
+        else if(ui8Char == ' ')
+        {
+            *pcOut++ = '+';
+        }
+        else
+        {
+            *pcOut++ = '%';
+            *pcOut++ = g_pcHexDigits[ui8Char >> 4];
+            *pcOut++ = g_pcHexDigits[ui8Char & 0xF];
+        }
+    }
+
+    return (pcOut - pcStart);
+}
+
+//*****************************************************************************
+//
+// A byte at a time decoder with the same rules as URLDecode().
+//
+//*****************************************************************************
+static int32_t
+HexValue(char cChar)
+{
+    if((cChar >= '0') && (cChar <= '9'))
+    {
+        return (cChar - '0');
+    }
+    if((cChar >= 'a') && (cChar <= 'f'))
+    {
+        return (cChar - 'a' + 10);
+    }
+    if((cChar >= 'A') && (cChar <= 'F'))
+    {
+        return (cChar - 'A' + 10);
+    }
+
+    return (-1);
+}
+
+static uint32_t
+OldURLDecode(char *pcBuf, uint32_t ui32Len)
+{
+    uint32_t ui32In, ui32Out;
+    int32_t i32Hi, i32Lo;
+
+    for(ui32In = 0, ui32Out = 0; ui32In < ui32Len; ui32Out++)
+    {
+        if(pcBuf[ui32In] == '+')
+        {
+            pcBuf[ui32Out] = ' ';
+            ui32In++;
+        }
+        else if((pcBuf[ui32In] == '%') && ((ui32Len - ui32In) >= 3) &&
+                ((i32Hi = HexValue(pcBuf[ui32In + 1])) >= 0) &&
+                ((i32Lo = HexValue(pcBuf[ui32In + 2])) >= 0))
+        {
+            pcBuf[ui32Out] = (i32Hi << 4) | i32Lo;
+            ui32In += 3;
+        }
+        else
+        {
+            pcBuf[ui32Out] = pcBuf[ui32In++];
+        }
+    }
+
+    pcBuf[ui32Out] = '\0';
+
+    return (ui32Out);
+}
+
+//*****************************************************************************
+//
+// Fills pcBuf with ui32Size bytes of one kind of input: plain text that needs
+// no encoding, e-mail addresses as in the emailaddr alias, or every byte
+// value in turn.
+//
+//*****************************************************************************
+typedef enum
+{
+    Input_Plain,
+    Input_Email,
+    Input_Binary
+} tInput;
+
+static const char * const g_ppcInputNames[] =
+{
+    "plain",
+    "email",
+    "binary"
+};
+
+static void
+BuildInput(char *pcBuf, uint32_t ui32Size, tInput eInput)
+{
+    static const char pcPlain[] = "Temperature_28.73-sensor~";
+    static const char pcEmail[] = "some.one+iot@example.com, ";
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < ui32Size; ui32Idx++)
+    {
+        if(eInput == Input_Plain)
+        {
+            pcBuf[ui32Idx] = pcPlain[ui32Idx % (sizeof(pcPlain) - 1)];
+        }
+        else if(eInput == Input_Email)
+        {
+            pcBuf[ui32Idx] = pcEmail[ui32Idx % (sizeof(pcEmail) - 1)];
+        }
+        else
+        {
+            pcBuf[ui32Idx] = (char)ui32Idx;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Round-trips every byte value, alone and in a longer string, through both
+// encoders and decoders.  Returns the number of mismatches.
+//
+//*****************************************************************************
+static uint32_t
+CheckRoundTrip(void)
+{
+    char pcIn[256], pcOld[(256 * 3) + 1], pcNew[(256 * 3) + 1];
+    uint32_t ui32Byte, ui32OldLen, ui32NewLen, ui32Errors = 0;
+
+    for(ui32Byte = 0; ui32Byte <= 256; ui32Byte++)
+    {
+        //
+        // A single byte, then for the last pass all 256 byte values.
+        //
+        if(ui32Byte < 256)
+        {
+            pcIn[0] = (char)ui32Byte;
+        }
+        else
+        {
+            BuildInput(pcIn, 256, Input_Binary);
+        }
+
+        ui32OldLen = OldURLEncode(pcOld, pcIn, (ui32Byte < 256) ? 1 : 256);
+        ui32NewLen = URLEncode(pcNew, pcIn, (ui32Byte < 256) ? 1 : 256);
+        if((ui32OldLen != ui32NewLen) ||
+           (ui32NewLen != URLEncodedLength(pcIn,
+                                           (ui32Byte < 256) ? 1 : 256)) ||
+           (memcmp(pcOld, pcNew, ui32NewLen) != 0))
+        {
+            ui32Errors++;
+            continue;
+        }
+
+        ui32OldLen = OldURLDecode(pcOld, ui32OldLen);
+        ui32NewLen = URLDecode(pcNew, ui32NewLen);
+        if((ui32OldLen != ((ui32Byte < 256) ? 1 : 256)) ||
+           (ui32NewLen != ui32OldLen) ||
+           (memcmp(pcOld, pcIn, ui32OldLen) != 0) ||
+           (memcmp(pcNew, pcIn, ui32NewLen) != 0))
+        {
+            ui32Errors++;
+        }
+    }
+
+    return (ui32Errors);
+}
+
+//*****************************************************************************
+//
+// Times ui32Rounds calls of an encoder, or of a decoder given a fresh copy of
+// its input each round as it works in place.  Returns the fastest of
+// BENCH_REPEATS measurements.
+//
+//*****************************************************************************
+static uint64_t
+TimeCodec(uint32_t (*pfnEncode)(char *, const char *, uint32_t),
+          uint32_t (*pfnDecode)(char *, uint32_t), const char *pcIn,
+          uint32_t ui32Len, uint32_t ui32Rounds)
+{
+    static char pcWork[(BENCH_MAX_SIZE * 3) + 1];
+    uint64_t ui64Start, ui64Time, ui64Best = UINT64_MAX;
+    uint32_t ui32Repeat, ui32Round;
+
+    for(ui32Repeat = 0; ui32Repeat < BENCH_REPEATS; ui32Repeat++)
+    {
+        ui64Start = CyclesGet();
+        for(ui32Round = 0; ui32Round < ui32Rounds; ui32Round++)
+        {
+            if(pfnEncode)
+            {
+                pfnEncode(pcWork, pcIn, ui32Len);
+            }
+            else
+            {
+                memcpy(pcWork, pcIn, ui32Len);
+                pfnDecode(pcWork, ui32Len);
+            }
+            __asm__ volatile("" : : "r"(pcWork) : "memory");
+        }
+        ui64Time = CyclesGet() - ui64Start;
+        if(ui64Time < ui64Best)
+        {
+            ui64Best = ui64Time;
+        }
+    }
+
+    return (ui64Best);
+}
+
+//*****************************************************************************
+//
+// Encodes, then decodes, one kind of input of each size with both versions
+// and prints the input bytes handled per unit of time.
+//
+//*****************************************************************************
+static void
+BenchInput(tInput eInput)
+{
+    static const uint32_t pui32Sizes[] = { 16, 64, 256, BENCH_MAX_SIZE };
+    static char pcIn[BENCH_MAX_SIZE];
+    static char pcEncoded[(BENCH_MAX_SIZE * 3) + 1];
+    uint64_t pui64Time[4];
+    uint32_t ui32Size, ui32Len, ui32EncLen, ui32Rounds;
+
+    for(ui32Size = 0; ui32Size < (sizeof(pui32Sizes) / sizeof(uint32_t));
+        ui32Size++)
+    {
+        ui32Len = pui32Sizes[ui32Size];
+        ui32Rounds = BENCH_BYTES / ui32Len;
+        BuildInput(pcIn, ui32Len, eInput);
+        ui32EncLen = URLEncode(pcEncoded, pcIn, ui32Len);
+
+        pui64Time[0] = TimeCodec(OldURLEncode, NULL, pcIn, ui32Len,
+                                 ui32Rounds);
+        pui64Time[1] = TimeCodec(URLEncode, NULL, pcIn, ui32Len, ui32Rounds);
+        pui64Time[2] = TimeCodec(NULL, OldURLDecode, pcEncoded, ui32EncLen,
+                                 ui32Rounds);
+        pui64Time[3] = TimeCodec(NULL, URLDecode, pcEncoded, ui32EncLen,
+                                 ui32Rounds);
+
+        printf("%-6s %5u  %8.3f %8.3f %6.2fx  %8.3f %8.3f %6.2fx\n",
+               g_ppcInputNames[eInput], ui32Len,
+               (double)BENCH_BYTES / pui64Time[0],
+               (double)BENCH_BYTES / pui64Time[1],
+               (double)pui64Time[0] / pui64Time[1],
+               (double)BENCH_BYTES / pui64Time[2],
+               (double)BENCH_BYTES / pui64Time[3],
+               (double)pui64Time[2] / pui64Time[3]);
+    }
+}
+
+//*****************************************************************************
+//
+// Check the round trip, then run the benchmark on each kind of input.
+//
+//*****************************************************************************
+int
+main(void)
+{
+    uint32_t ui32Errors;
+
+    ui32Errors = CheckRoundTrip();
+    printf("Round trip of every byte value: %s.\n\n",
+           (ui32Errors ? "FAILED" : "passed"));
+
+    printf("Input bytes per %s, fastest of %u measurements of %u bytes.\n",
+           (CYCLES_UNIT[0] == 'c') ? "cycle" : "ns", BENCH_REPEATS,
+           BENCH_BYTES);
+    printf("%-6s %5s  %8s %8s %7s  %8s %8s %7s\n", "input", "bytes",
+           "old enc", "new enc", "speedup", "old dec", "new dec", "speedup");
+    BenchInput(Input_Plain);
+    BenchInput(Input_Email);
+    BenchInput(Input_Binary);
+
+    return (ui32Errors ? 1 : 0);
+}
@@ -0,0 +1,228 @@
+//*****************************************************************************
+//
+// latency.c - Latency histograms of the phases of the cloud requests.
+//
+// Copyright (c) 2015 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+//
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+//
+//*****************************************************************************
+
+
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <xdc/std.h>
+#include <xdc/runtime/Timestamp.h>
+#include <xdc/runtime/Types.h>
+#include "latency.h"
+
+//*****************************************************************************
+//
+// The histograms, by the LATENCY_* labels, and the names of the phases.
+//
+//*****************************************************************************
+tLatencyHistogram g_psLatency[NUM_LATENCY_PHASES];
+const char * const g_ppcLatencyPhases[NUM_LATENCY_PHASES] =
+{
+    "dns",
+    "tcp",
+    "tls",
+    "send",
+    "ttfb",
+    "body"
+};
+
+//*****************************************************************************
+//
+// Timestamp counts per microsecond.
+//
+//*****************************************************************************
+static uint32_t g_ui32CountsPerUs = 1;
+
+//*****************************************************************************
+//
+// Returns the histogram bucket of a duration, which is its number of
+// significant bits.
+//
+//*****************************************************************************
+static uint32_t
+LatencyBucket(uint32_t ui32Us)
+{
+    uint32_t ui32Bucket = 0;
+
+    if(ui32Us >= (1 << 16))
+    {
+        ui32Bucket += 16;
+        ui32Us >>= 16;
+    }
+    if(ui32Us >= (1 << 8))
+    {
+        ui32Bucket += 8;
+        ui32Us >>= 8;
+    }
+    if(ui32Us >= (1 << 4))
+    {
+        ui32Bucket += 4;
+        ui32Us >>= 4;
+    }
+    if(ui32Us >= (1 << 2))
+    {
+        ui32Bucket += 2;
+        ui32Us >>= 2;
+    }
+    if(ui32Us >= (1 << 1))
+    {
+        ui32Bucket += 1;
+        ui32Us >>= 1;
+    }
+    ui32Bucket += ui32Us;
+
+    return ((ui32Bucket < LATENCY_BUCKETS) ? ui32Bucket :
+            (LATENCY_BUCKETS - 1));
+}
+
+//*****************************************************************************
+//
+// Reads the timestamp frequency and clears the histograms.
+//
+//*****************************************************************************
+void
+LatencyInit(void)
+{
+    Types_FreqHz sFreq;
+
+    Timestamp_getFreq(&sFreq);
+    if(sFreq.lo >= 1000000)
+    {
+        g_ui32CountsPerUs = sFreq.lo / 1000000;
+    }
+
+    LatencyReset();
+}
+
+//*****************************************************************************
+//
+// Clears the histograms.
+//
+//*****************************************************************************
+void
+LatencyReset(void)
+{
+    uint32_t ui32Phase;
+
+    memset(g_psLatency, 0, sizeof(g_psLatency));
+    for(ui32Phase = 0; ui32Phase < NUM_LATENCY_PHASES; ui32Phase++)
+    {
+        g_psLatency[ui32Phase].ui32MinUs = 0xFFFFFFFF;
+    }
+}
+
+//*****************************************************************************
+//
+// Starts timing the first phase of a connect or a request.
+//
+//*****************************************************************************
+void
+LatencyStart(tLatencyTimer *psTimer)
+{
+    psTimer->ui32Last = Timestamp_get32();
+}
+
+//*****************************************************************************
+//
+// Ends a phase.  Its duration since the last phase boundary is added to its
+// histogram, and the next phase starts.  This only reads the timestamp
+// counter and updates a few counters, so it can be left enabled.
+//
+//*****************************************************************************
+void
+LatencyMark(tLatencyTimer *psTimer, uint32_t ui32Phase)
+{
+    tLatencyHistogram *psHistogram;
+    uint32_t ui32Now, ui32Us;
+
+    ui32Now = Timestamp_get32();
+    ui32Us = (ui32Now - psTimer->ui32Last) / g_ui32CountsPerUs;
+    psTimer->ui32Last = ui32Now;
+
+    psHistogram = &g_psLatency[ui32Phase];
+    psHistogram->ui32Count++;
+    psHistogram->ui64TotalUs += ui32Us;
+    if(ui32Us < psHistogram->ui32MinUs)
+    {
+        psHistogram->ui32MinUs = ui32Us;
+    }
+    if(ui32Us > psHistogram->ui32MaxUs)
+    {
+        psHistogram->ui32MaxUs = ui32Us;
+    }
+    psHistogram->pui32Buckets[LatencyBucket(ui32Us)]++;
+}
+
+//*****************************************************************************
+//
+// Returns the average duration of a phase in microseconds, 0 if it was never
+// timed.
+//
+//*****************************************************************************
+uint32_t
+LatencyAverage(const tLatencyHistogram *psHistogram)
+{
+    if(psHistogram->ui32Count == 0)
+    {
+        return (0);
+    }
+
+    return ((uint32_t)(psHistogram->ui64TotalUs / psHistogram->ui32Count));
+}
+
+//*****************************************************************************
+//
+// Returns an upper bound of the given percentile of the durations of a phase
+// in microseconds, that is the upper end of the bucket that holds it, but no
+// more than the longest duration.  Returns 0 if the phase was never timed.
+//
+//*****************************************************************************
+uint32_t
+LatencyPercentile(const tLatencyHistogram *psHistogram, uint32_t ui32Percent)
+{
+    uint32_t ui32Rank, ui32Sum, ui32Bucket;
+
+    if(psHistogram->ui32Count == 0)
+    {
+        return (0);
+    }
+
+    ui32Rank = ((psHistogram->ui32Count * ui32Percent) + 99) / 100;
+    ui32Sum = 0;
+    for(ui32Bucket = 0; ui32Bucket < (LATENCY_BUCKETS - 1); ui32Bucket++)
+    {
+        ui32Sum += psHistogram->pui32Buckets[ui32Bucket];
+        if(ui32Sum >= ui32Rank)
+        {
+            break;
+        }
+    }
+
+    if(((1 << ui32Bucket) - 1) < psHistogram->ui32MaxUs)
+    {
+        return ((1 << ui32Bucket) - 1);
+    }
+
+    return (psHistogram->ui32MaxUs);
+}
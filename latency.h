@@ -0,0 +1,93 @@
+//*****************************************************************************
+//
+// latency.h - Latency histograms of the phases of the cloud requests.
+//
+// Copyright (c) 2015 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+//
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+//
+//*****************************************************************************
+
+
+#ifndef __LATENCY_H__
+#define __LATENCY_H__
+
+//*****************************************************************************
+//
+// Phases of a connect and of a request, by index in g_psLatency.  DNS is the
+// name lookup, TCP the connect race, TLS the connect and handshake of the
+// HTTP client, Send the writing of the request, First Byte the wait for the
+// response status and Body the reading of the headers and body.
+//
+//*****************************************************************************
+#define LATENCY_DNS             0
+#define LATENCY_TCP             1
+#define LATENCY_TLS             2
+#define LATENCY_SEND            3
+#define LATENCY_FIRST_BYTE      4
+#define LATENCY_BODY            5
+#define NUM_LATENCY_PHASES      6
+
+//*****************************************************************************
+//
+// Number of histogram buckets.  Bucket n counts the durations from 2^(n-1)
+// to 2^n - 1 microseconds, the last one also counts all longer durations.
+//
+//*****************************************************************************
+#define LATENCY_BUCKETS         26
+
+//*****************************************************************************
+//
+// Durations of one phase, in microseconds.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32Count;
+    uint32_t ui32MinUs;
+    uint32_t ui32MaxUs;
+    uint64_t ui64TotalUs;
+    uint32_t pui32Buckets[LATENCY_BUCKETS];
+} tLatencyHistogram;
+
+//*****************************************************************************
+//
+// Timestamp of the last phase boundary.  The timestamp counter wraps, so a
+// phase must not last longer than a few tens of seconds.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32Last;
+} tLatencyTimer;
+
+extern tLatencyHistogram g_psLatency[NUM_LATENCY_PHASES];
+extern const char * const g_ppcLatencyPhases[NUM_LATENCY_PHASES];
+
+//*****************************************************************************
+//
+// Prototypes of the functions that are called from outside the latency.c
+// module.
+//
+//*****************************************************************************
+extern void LatencyInit(void);
+extern void LatencyReset(void);
+extern void LatencyStart(tLatencyTimer *psTimer);
+extern void LatencyMark(tLatencyTimer *psTimer, uint32_t ui32Phase);
+extern uint32_t LatencyAverage(const tLatencyHistogram *psHistogram);
+extern uint32_t LatencyPercentile(const tLatencyHistogram *psHistogram,
+                                  uint32_t ui32Percent);
+
+#endif // __LATENCY_H__
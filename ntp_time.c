@@ -36,6 +36,7 @@
 #include <xdc/runtime/System.h>
 #include "cloud_task.h"
 #include "command_task.h"
+#include "dns_cache.h"
 #include "ntp_time.h"
 
 //*****************************************************************************
@@ -231,19 +232,20 @@ StartNTPServer(struct in_addr sNTPIP)
 
 //*****************************************************************************
 //
-// Resolve the IP address of the URL provided.
+// Resolve the IP address of the URL provided.  The address is looked up in
+// the DNS cache shared with the Cloud task.
 //
 //*****************************************************************************
 int32_t
 ResolveNTPURL(struct sockaddr * sNTPSockAddr, char * pcNTPServer)
 {
-    int32_t i32Ret;;
+    struct sockaddr_in *psAddr = (struct sockaddr_in *)sNTPSockAddr;
+    uint32_t ui32Addr;
 
     //
-    // Set-up a socket to resolve NTP server's IP.
+    // Look up the NTP server's IP.
     //
-    i32Ret = HTTPCli_initSockAddr(sNTPSockAddr, pcNTPServer, 0);
-    if(i32Ret != 0)
+    if(DNSCacheLookup(pcNTPServer, &ui32Addr, 1) <= 0)
     {
         //
         // Failed to Resolve IP.  Report error.
@@ -251,6 +253,10 @@ ResolveNTPURL(struct sockaddr * sNTPSockAddr, char * pcNTPServer)
         return -1;
     }
 
+    memset(psAddr, 0, sizeof(struct sockaddr_in));
+    psAddr->sin_family = AF_INET;
+    psAddr->sin_addr.s_addr = ui32Addr;
+
     return 0;
 }
 
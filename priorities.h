@@ -29,6 +29,7 @@
 //
 //*****************************************************************************
 #define PRIORITY_CLOUD_TASK     1
+#define PRIORITY_LONGPOLL_TASK  1
 //#define PRIORITY_COMMAND_TASK   1
 
 
@@ -90,6 +90,14 @@ void netIPAddrHook(uint32_t ui32IPAddr, uint32_t ui32IfIdx, uint32_t ui32FAdd)
 
         bFirstTime = true;
     }
+    else if(ui32FAdd)
+    {
+        //
+        // The address was acquired again.  Wake the Cloud task so that it
+        // reconnects without waiting for its retry delay.
+        //
+        CloudNotify(CLOUD_EVENT_NETWORK);
+    }
 }
 
 //*****************************************************************************
@@ -0,0 +1,154 @@
+//*****************************************************************************
+//
+// send_buffer.c - Coalesces small request writes into larger TLS records.
+//
+// Copyright (c) 2015 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+//
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+//
+//*****************************************************************************
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <ti/net/http/httpcli.h>
+#include "send_buffer.h"
+
+//*****************************************************************************
+//
+// Global resource to select whether request writes are collected in a buffer
+// before being written to the connection, or written as they are made.  This
+// can be changed from the console to compare both modes.
+//
+//*****************************************************************************
+bool g_bSendBuffered = true;
+
+//*****************************************************************************
+//
+// Global resource to count the writes made to the connections.
+//
+//*****************************************************************************
+tSendBufferStats g_sSendBufferStats;
+
+//*****************************************************************************
+//
+// Write data to the connection and count it.
+//
+//*****************************************************************************
+static int32_t
+SendBufferSend(HTTPCli_Handle cli, const char *pcBuf, uint32_t ui32Len)
+{
+    int32_t i32Ret;
+
+    i32Ret = HTTPCli_sendRequestBody(cli, pcBuf, ui32Len);
+    if(i32Ret < 0)
+    {
+        return (i32Ret);
+    }
+
+    g_sSendBufferStats.ui32BodyRecords++;
+    g_sSendBufferStats.ui32BodyBytes += ui32Len;
+
+    return (0);
+}
+
+//*****************************************************************************
+//
+// Initialize a buffer for a new request on the given HTTP client instance.
+//
+//*****************************************************************************
+void
+SendBufferInit(tSendBuffer *psSend, HTTPCli_Handle cli)
+{
+    psSend->cli = cli;
+    psSend->ui32Len = 0;
+}
+
+//*****************************************************************************
+//
+// Add data to the buffer.  The buffer is written to the connection whenever
+// it fills up.  Data that is larger than the buffer is written directly.
+// Returns 0 on success or a negative HTTPCli error.
+//
+//*****************************************************************************
+int32_t
+SendBufferWrite(tSendBuffer *psSend, const char *pcBuf, uint32_t ui32Len)
+{
+    uint32_t ui32Copy;
+    int32_t i32Ret;
+
+    if(!g_bSendBuffered)
+    {
+        return ((ui32Len != 0) ? SendBufferSend(psSend->cli, pcBuf, ui32Len) :
+                0);
+    }
+
+    while(ui32Len != 0)
+    {
+        //
+        // Skip the copy if the buffer is empty and the data would fill it
+        // anyway.
+        //
+        if((psSend->ui32Len == 0) && (ui32Len >= SEND_BUFFER_SIZE))
+        {
+            return (SendBufferSend(psSend->cli, pcBuf, ui32Len));
+        }
+
+        ui32Copy = SEND_BUFFER_SIZE - psSend->ui32Len;
+        if(ui32Copy > ui32Len)
+        {
+            ui32Copy = ui32Len;
+        }
+
+        memcpy((psSend->pcBuf + psSend->ui32Len), pcBuf, ui32Copy);
+        psSend->ui32Len += ui32Copy;
+        pcBuf += ui32Copy;
+        ui32Len -= ui32Copy;
+
+        if(psSend->ui32Len == SEND_BUFFER_SIZE)
+        {
+            i32Ret = SendBufferFlush(psSend);
+            if(i32Ret < 0)
+            {
+                return (i32Ret);
+            }
+        }
+    }
+
+    return (0);
+}
+
+//*****************************************************************************
+//
+// Write any data left in the buffer to the connection.  This must be called
+// at the end of every request.  Returns 0 on success or a negative HTTPCli
+// error.
+//
+//*****************************************************************************
+int32_t
+SendBufferFlush(tSendBuffer *psSend)
+{
+    uint32_t ui32Len;
+
+    ui32Len = psSend->ui32Len;
+    psSend->ui32Len = 0;
+    if(ui32Len == 0)
+    {
+        return (0);
+    }
+
+    return (SendBufferSend(psSend->cli, psSend->pcBuf, ui32Len));
+}
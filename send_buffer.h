@@ -0,0 +1,87 @@
+//*****************************************************************************
+//
+// send_buffer.h - Coalesces small request writes into larger TLS records.
+//
+// Copyright (c) 2015 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+//
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+//
+//*****************************************************************************
+
+
+#ifndef __SEND_BUFFER_H__
+#define __SEND_BUFFER_H__
+
+//*****************************************************************************
+//
+// Label that defines how many bytes are collected before they are written to
+// the connection.  Each write becomes one TLS record, so this matches the TCP
+// transmit buffer size set in secure_iot.cfg.
+//
+//*****************************************************************************
+#ifndef SEND_BUFFER_SIZE
+#define SEND_BUFFER_SIZE        1024
+#endif
+
+//*****************************************************************************
+//
+// Buffer that collects the writes of one request.  It is meant to be placed
+// on the stack of the function that sends the request.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // HTTP client instance that the buffer is written to.
+    //
+    HTTPCli_Handle cli;
+
+    //
+    // Number of bytes in pcBuf that have not been written yet.
+    //
+    uint32_t ui32Len;
+    char pcBuf[SEND_BUFFER_SIZE];
+} tSendBuffer;
+
+//*****************************************************************************
+//
+// Counters of the writes made through the send buffer, used to compare the
+// buffered and the unbuffered modes.  Each write is sent as one TLS record.
+// Only the header fields and the body written by this module are counted.
+// The request line and the Host field that HTTPCli_sendRequest() writes
+// before them, in records of their own, are not.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32BodyRecords;
+    uint32_t ui32BodyBytes;
+} tSendBufferStats;
+
+extern bool g_bSendBuffered;
+extern tSendBufferStats g_sSendBufferStats;
+
+//*****************************************************************************
+//
+// Prototypes of the functions that are called from outside the send_buffer.c
+// module.
+//
+//*****************************************************************************
+extern void SendBufferInit(tSendBuffer *psSend, HTTPCli_Handle cli);
+extern int32_t SendBufferWrite(tSendBuffer *psSend, const char *pcBuf,
+                               uint32_t ui32Len);
+extern int32_t SendBufferFlush(tSendBuffer *psSend);
+
+#endif // __SEND_BUFFER_H__
@@ -0,0 +1,418 @@
+//*****************************************************************************
+//
+// telemetry.c - Samples the board sensors into a buffer for batch uploads.
+// Samples that can't be uploaded are kept in an outbox in EEPROM.
+//
+// Copyright (c) 2015 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+//
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+//
+//*****************************************************************************
+
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <xdc/std.h>
+#include <ti/sysbios/hal/Seconds.h>
+#include <ti/sysbios/knl/Clock.h>
+#include <xdc/runtime/Error.h>
+#include "board_funcs.h"
+#include "cloud_task.h"
+#include "telemetry.h"
+
+//*****************************************************************************
+//
+// Ring buffer of samples.  Samples are added at g_ui32Head by the sampler
+// clock function and removed from g_ui32Tail by the Cloud task once they are
+// uploaded.  Each index is only written by one side, so no lock is needed.
+//
+//*****************************************************************************
+static tTelemetrySample g_psSamples[TELEMETRY_BUFFER_SIZE];
+static volatile uint32_t g_ui32Head;
+static volatile uint32_t g_ui32Tail;
+
+//*****************************************************************************
+//
+// Head and tail record counts of the EEPROM outbox.  The RAM buffer acts as
+// a write-back cache in front of the outbox: samples stay in RAM while they
+// can be uploaded and are only spilled to EEPROM by TelemetrySpill() when the
+// server can't be reached.  The outbox always holds samples older than the
+// ones in RAM, so together they are in order, oldest first.  These are only
+// used by the Cloud task.
+//
+//*****************************************************************************
+static uint32_t g_ui32OutboxHead;
+static uint32_t g_ui32OutboxTail;
+
+//*****************************************************************************
+//
+// Time in seconds of the first upload from the outbox since it was last
+// empty and the number of samples drained since, used to compute the drain
+// rate.
+//
+//*****************************************************************************
+static uint32_t g_ui32DrainStart;
+static uint32_t g_ui32DrainCount;
+
+//*****************************************************************************
+//
+// Global resources to hold the sampler clock and the current configuration.
+//
+//*****************************************************************************
+static Clock_Handle g_psSampleClock = NULL;
+static uint32_t g_ui32Period = TELEMETRY_PERIOD;
+static uint32_t g_ui32Batch = TELEMETRY_BATCH;
+
+//*****************************************************************************
+//
+// Global resource to hold the sampler and upload counters.
+//
+//*****************************************************************************
+tTelemetryStats g_sTelemetryStats;
+
+//*****************************************************************************
+//
+// Clock function that takes a sample of the board sensors.  If the buffer is
+// full, the new sample is dropped so that samples waiting to be uploaded are
+// not changed under the Cloud task.
+//
+//*****************************************************************************
+static Void
+TelemetrySample(UArg arg)
+{
+    uint32_t pui32Buttons[2];
+    uint32_t ui32Head;
+    tTelemetrySample *psSample;
+
+    ui32Head = g_ui32Head;
+    if((ui32Head - g_ui32Tail) >= TELEMETRY_BUFFER_SIZE)
+    {
+        g_sTelemetryStats.ui32Dropped++;
+        return;
+    }
+
+    psSample = &g_psSamples[ui32Head % TELEMETRY_BUFFER_SIZE];
+    ReadButtons(pui32Buttons);
+    psSample->ui32Time = Seconds_get();
+    psSample->ui16Temp = ReadInternalTemp();
+    psSample->ui32Switch1 = pui32Buttons[0];
+    psSample->ui32Switch2 = pui32Buttons[1];
+
+    g_ui32Head = ui32Head + 1;
+    g_sTelemetryStats.ui32Samples++;
+
+    //
+    // Wake the Cloud task once the buffer is half full, so that the samples
+    // are uploaded or spilled to EEPROM before it overflows.
+    //
+    if((ui32Head + 1 - g_ui32Tail) == (TELEMETRY_BUFFER_SIZE / 2))
+    {
+        CloudNotify(CLOUD_EVENT_TELEMETRY);
+    }
+}
+
+//*****************************************************************************
+//
+// Create the sampler clock and load the outbox saved in EEPROM.  The clock
+// is started if the default batch size is not 0.  This must be called after
+// the time is synced with the NTP server, as the samples are timestamped.
+//
+//*****************************************************************************
+int32_t
+TelemetryInit(void)
+{
+    Clock_Params sClockParams;
+    Error_Block sEB;
+
+    //
+    // Samples left in the outbox before a reset are still uploaded.
+    //
+    if(!GetOutboxEEPROM(&g_ui32OutboxHead, &g_ui32OutboxTail))
+    {
+        g_ui32OutboxHead = 0;
+        g_ui32OutboxTail = 0;
+        SaveOutboxEEPROM(0, 0);
+    }
+
+    Error_init(&sEB);
+
+    //
+    // Clock ticks are 1 ms.
+    //
+    Clock_Params_init(&sClockParams);
+    sClockParams.period = g_ui32Period;
+    sClockParams.startFlag = (g_ui32Batch != 0);
+    g_psSampleClock = Clock_create(TelemetrySample, g_ui32Period,
+                                   &sClockParams, &sEB);
+    if(g_psSampleClock == NULL)
+    {
+        return (-1);
+    }
+
+    return (0);
+}
+
+//*****************************************************************************
+//
+// Change the time between samples and the number of samples uploaded per
+// request.  A batch size of 0 stops the sampler.
+//
+//*****************************************************************************
+void
+TelemetryConfig(uint32_t ui32PeriodMs, uint32_t ui32Batch)
+{
+    if(ui32Batch > TELEMETRY_BUFFER_SIZE)
+    {
+        ui32Batch = TELEMETRY_BUFFER_SIZE;
+    }
+
+    g_ui32Period = ui32PeriodMs;
+    g_ui32Batch = ui32Batch;
+
+    if(g_psSampleClock == NULL)
+    {
+        return;
+    }
+
+    Clock_stop(g_psSampleClock);
+    Clock_setPeriod(g_psSampleClock, ui32PeriodMs);
+    Clock_setTimeout(g_psSampleClock, ui32PeriodMs);
+    if(ui32Batch != 0)
+    {
+        Clock_start(g_psSampleClock);
+    }
+}
+
+//*****************************************************************************
+//
+// Returns the time between samples in milliseconds.
+//
+//*****************************************************************************
+uint32_t
+TelemetryPeriod(void)
+{
+    return (g_ui32Period);
+}
+
+//*****************************************************************************
+//
+// Returns the number of samples uploaded per request, or 0 if the sampler is
+// disabled.
+//
+//*****************************************************************************
+uint32_t
+TelemetryBatch(void)
+{
+    return (g_ui32Batch);
+}
+
+//*****************************************************************************
+//
+// Returns the number of samples waiting to be uploaded, in the outbox and in
+// RAM.
+//
+//*****************************************************************************
+uint32_t
+TelemetryCount(void)
+{
+    return ((g_ui32OutboxHead - g_ui32OutboxTail) + (g_ui32Head - g_ui32Tail));
+}
+
+//*****************************************************************************
+//
+// Returns the number of samples in the EEPROM outbox.
+//
+//*****************************************************************************
+uint32_t
+TelemetryOutboxCount(void)
+{
+    return (g_ui32OutboxHead - g_ui32OutboxTail);
+}
+
+//*****************************************************************************
+//
+// Returns the age in seconds of the oldest sample waiting to be uploaded, or
+// 0 if there is none.
+//
+//*****************************************************************************
+uint32_t
+TelemetryOldestAge(void)
+{
+    tTelemetrySample sSample;
+
+    if(TelemetryCount() == 0)
+    {
+        return (0);
+    }
+
+    TelemetryGet(0, &sSample);
+
+    return (Seconds_get() - sSample.ui32Time);
+}
+
+//*****************************************************************************
+//
+// Returns the number of samples to upload with the next request, or 0 if no
+// upload is due.  While the outbox is draining, larger batches are uploaded.
+// Samples left over after the sampler was disabled are uploaded all at once.
+//
+//*****************************************************************************
+uint32_t
+TelemetryUploadSize(void)
+{
+    uint32_t ui32Count;
+
+    ui32Count = TelemetryCount();
+    if(TelemetryOutboxCount() != 0)
+    {
+        return ((ui32Count < TELEMETRY_DRAIN_SIZE) ? ui32Count :
+                TELEMETRY_DRAIN_SIZE);
+    }
+    if(g_ui32Batch == 0)
+    {
+        return (ui32Count);
+    }
+
+    return ((ui32Count >= g_ui32Batch) ? g_ui32Batch : 0);
+}
+
+//*****************************************************************************
+//
+// Copy a sample without removing it.  ui32Index 0 is the oldest sample and
+// must be lower than TelemetryCount().  The samples in the outbox come first.
+//
+//*****************************************************************************
+void
+TelemetryGet(uint32_t ui32Index, tTelemetrySample *psSample)
+{
+    uint32_t pui32Record[OUTBOX_RECORD_SIZE / 4];
+
+    if(ui32Index < TelemetryOutboxCount())
+    {
+        ReadOutboxRecordEEPROM(g_ui32OutboxTail + ui32Index, pui32Record);
+        psSample->ui32Time = pui32Record[0];
+        psSample->ui32Switch1 = pui32Record[1];
+        psSample->ui32Switch2 = pui32Record[2];
+        psSample->ui16Temp = (uint16_t)pui32Record[3];
+        return;
+    }
+
+    ui32Index -= TelemetryOutboxCount();
+    *psSample = g_psSamples[(g_ui32Tail + ui32Index) % TELEMETRY_BUFFER_SIZE];
+}
+
+//*****************************************************************************
+//
+// Remove the oldest samples once the server has acknowledged them.  Samples
+// are removed from the outbox first, and the outbox header is updated in
+// EEPROM so they are not uploaded again after a reset.
+//
+//*****************************************************************************
+void
+TelemetryRemove(uint32_t ui32Count)
+{
+    uint32_t ui32Outbox, ui32Now;
+
+    if(ui32Count > TelemetryCount())
+    {
+        ui32Count = TelemetryCount();
+    }
+
+    ui32Outbox = TelemetryOutboxCount();
+    if(ui32Outbox > ui32Count)
+    {
+        ui32Outbox = ui32Count;
+    }
+    if(ui32Outbox != 0)
+    {
+        g_ui32OutboxTail += ui32Outbox;
+        SaveOutboxEEPROM(g_ui32OutboxHead, g_ui32OutboxTail);
+
+        //
+        // Update the drain rate.
+        //
+        ui32Now = Seconds_get();
+        if(g_ui32DrainCount == 0)
+        {
+            g_ui32DrainStart = ui32Now;
+        }
+        g_ui32DrainCount += ui32Outbox;
+        g_sTelemetryStats.ui32Drained += ui32Outbox;
+        g_sTelemetryStats.ui32DrainRate =
+            g_ui32DrainCount / (((ui32Now - g_ui32DrainStart) != 0) ?
+                                (ui32Now - g_ui32DrainStart) : 1);
+    }
+
+    g_ui32Tail += ui32Count - ui32Outbox;
+}
+
+//*****************************************************************************
+//
+// Move the samples in RAM to the EEPROM outbox.  This is called by the Cloud
+// task while the server can't be reached, so the samples survive a reset and
+// the RAM buffer does not overflow.  If the outbox is full, its oldest
+// samples are overwritten.
+//
+//*****************************************************************************
+void
+TelemetrySpill(void)
+{
+    uint32_t pui32Record[OUTBOX_RECORD_SIZE / 4];
+    tTelemetrySample *psSample;
+    uint32_t ui32Count, ui32Idx;
+
+    ui32Count = g_ui32Head - g_ui32Tail;
+    if(ui32Count == 0)
+    {
+        return;
+    }
+
+    //
+    // A new drain starts once the server can be reached again.
+    //
+    if(TelemetryOutboxCount() == 0)
+    {
+        g_ui32DrainCount = 0;
+    }
+
+    for(ui32Idx = 0; ui32Idx < ui32Count; ui32Idx++)
+    {
+        psSample = &g_psSamples[(g_ui32Tail + ui32Idx) %
+                                TELEMETRY_BUFFER_SIZE];
+        pui32Record[0] = psSample->ui32Time;
+        pui32Record[1] = psSample->ui32Switch1;
+        pui32Record[2] = psSample->ui32Switch2;
+        pui32Record[3] = psSample->ui16Temp;
+
+        if(TelemetryOutboxCount() == OUTBOX_RECORDS)
+        {
+            g_ui32OutboxTail++;
+            g_sTelemetryStats.ui32Lost++;
+        }
+        if(!SaveOutboxRecordEEPROM(g_ui32OutboxHead, pui32Record))
+        {
+            break;
+        }
+        g_ui32OutboxHead++;
+    }
+
+    //
+    // Write the header after the records, then release the samples from RAM.
+    //
+    SaveOutboxEEPROM(g_ui32OutboxHead, g_ui32OutboxTail);
+    g_ui32Tail += ui32Idx;
+    g_sTelemetryStats.ui32Spilled += ui32Idx;
+}
@@ -0,0 +1,105 @@
+//*****************************************************************************
+//
+// telemetry.h - Samples the board sensors into a buffer for batch uploads.
+//
+// Copyright (c) 2015 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+//
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+//
+//*****************************************************************************
+
+
+#ifndef __TELEMETRY_H__
+#define __TELEMETRY_H__
+
+//*****************************************************************************
+//
+// Labels that define the number of samples held in RAM, the default time
+// between samples in milliseconds and the default number of samples uploaded
+// per request.  A batch size of 0 disables the sampler, in which case the
+// sensor values are written with every sync as before.  The buffer size must
+// be a power of 2.
+//
+//*****************************************************************************
+#define TELEMETRY_BUFFER_SIZE   64
+#define TELEMETRY_PERIOD        200
+#define TELEMETRY_BATCH         0
+
+//*****************************************************************************
+//
+// Labels that define how the EEPROM outbox is drained once the server can be
+// reached again: the number of samples uploaded per request and the number of
+// requests made per sync cycle.
+//
+//*****************************************************************************
+#define TELEMETRY_DRAIN_SIZE    32
+#define TELEMETRY_DRAIN_BATCHES 4
+
+//*****************************************************************************
+//
+// One timestamped sample of the board sensors.  The time is in seconds since
+// the Unix epoch, the switch values are press counts since reset.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32Time;
+    uint32_t ui32Switch1;
+    uint32_t ui32Switch2;
+    uint16_t ui16Temp;
+} tTelemetrySample;
+
+//*****************************************************************************
+//
+// Sampler, upload and outbox counters.  Samples are dropped when the RAM
+// buffer is full.  Spilled samples were moved from RAM to the EEPROM outbox,
+// drained samples were removed from the outbox after a successful upload and
+// lost samples were overwritten because the outbox was full.  The drain rate
+// is in samples per second since the outbox started draining.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32Samples;
+    uint32_t ui32Dropped;
+    uint32_t ui32Uploads;
+    uint32_t ui32Failed;
+    uint32_t ui32Spilled;
+    uint32_t ui32Drained;
+    uint32_t ui32Lost;
+    uint32_t ui32DrainRate;
+} tTelemetryStats;
+
+extern tTelemetryStats g_sTelemetryStats;
+
+//*****************************************************************************
+//
+// Prototypes of the functions that are called from outside the telemetry.c
+// module.
+//
+//*****************************************************************************
+extern int32_t TelemetryInit(void);
+extern void TelemetryConfig(uint32_t ui32PeriodMs, uint32_t ui32Batch);
+extern uint32_t TelemetryPeriod(void);
+extern uint32_t TelemetryBatch(void);
+extern uint32_t TelemetryCount(void);
+extern uint32_t TelemetryOutboxCount(void);
+extern uint32_t TelemetryOldestAge(void);
+extern uint32_t TelemetryUploadSize(void);
+extern void TelemetryGet(uint32_t ui32Index, tTelemetrySample *psSample);
+extern void TelemetryRemove(uint32_t ui32Count);
+extern void TelemetrySpill(void);
+
+#endif // __TELEMETRY_H__
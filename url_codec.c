@@ -0,0 +1,276 @@
+//*****************************************************************************
+//
+// url_codec.c - Table driven URL encoding and decoding.
+//
+// Copyright (c) 2015 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+//
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+//
+//*****************************************************************************
+
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "url_codec.h"
+
+//*****************************************************************************
+//
+// Encoding class of each byte.  The low 2 bits hold the length of the byte
+// once encoded.  Letters, digits and "-._~" are copied as they are and have
+// the class URL_COPY, a space is encoded as '+' and every other byte becomes
+// a %XX escape.
+//
+//*****************************************************************************
+#define URL_COPY                0x01
+#define URL_PLUS                0x05
+#define URL_ESCAPE              0x03
+#define URL_LEN_M               0x03
+
+static const uint8_t g_pui8URLEncodeClass[256] =
+{
+    0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03,
+    0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03,
+    0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03,
+    0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03,
+    0x05, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03,
+    0x03, 0x03, 0x03, 0x03, 0x03, 0x01, 0x01, 0x03,
+    0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+    0x01, 0x01, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03,
+    0x03, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+    0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+    0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+    0x01, 0x01, 0x01, 0x03, 0x03, 0x03, 0x03, 0x01,
+    0x03, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+    0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+    0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+    0x01, 0x01, 0x01, 0x03, 0x03, 0x03, 0x01, 0x03,
+    0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03,
+    0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03,
+    0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03,
+    0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03,
+    0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03,
+    0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03,
+    0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03,
+    0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03,
+    0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03,
+    0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03,
+    0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03,
+    0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03,
+    0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03,
+    0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03,
+    0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03,
+    0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03
+};
+
+//*****************************************************************************
+//
+// Decoding class of each byte.  Hex digits hold their value, '%' and '+'
+// have the URL_SPECIAL bit set and every other byte has the URL_NOT_HEX
+// bit set.
+//
+//*****************************************************************************
+#define URL_SPECIAL             0x40
+#define URL_NOT_HEX             0x80
+
+static const uint8_t g_pui8URLDecodeClass[256] =
+{
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x40, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x40, 0x80, 0x80, 0x80, 0x80,
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+    0x08, 0x09, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80
+};
+
+//*****************************************************************************
+//
+// Upper case hexadecimal digits used for the %XX escapes.
+//
+//*****************************************************************************
+static const char g_pcURLHexDigits[] = "0123456789ABCDEF";
+
+//*****************************************************************************
+//
+// Returns the length of the first ui32Len bytes of pcIn once URL encoded.
+// This lets a caller size a buffer or a Content-Length header up front.
+//
+//*****************************************************************************
+uint32_t
+URLEncodedLength(const char *pcIn, uint32_t ui32Len)
+{
+    const uint8_t *pui8In = (const uint8_t *)pcIn;
+    uint32_t ui32Out = 0;
+
+    //
+    // Four bytes at a time, then the rest one at a time.
+    //
+    while(ui32Len >= 4)
+    {
+        ui32Out += ((g_pui8URLEncodeClass[pui8In[0]] & URL_LEN_M) +
+                    (g_pui8URLEncodeClass[pui8In[1]] & URL_LEN_M) +
+                    (g_pui8URLEncodeClass[pui8In[2]] & URL_LEN_M) +
+                    (g_pui8URLEncodeClass[pui8In[3]] & URL_LEN_M));
+        pui8In += 4;
+        ui32Len -= 4;
+    }
+
+    while(ui32Len--)
+    {
+        ui32Out += g_pui8URLEncodeClass[*pui8In++] & URL_LEN_M;
+    }
+
+    return (ui32Out);
+}
+
+//*****************************************************************************
+//
+// URL encodes the first ui32Len bytes of pcIn to pcOut, which must hold
+// URLEncodedLength() bytes.  The output is not 0 terminated.  Returns the
+// length of the output.
+//
+//*****************************************************************************
+uint32_t
+URLEncode(char *pcOut, const char *pcIn, uint32_t ui32Len)
+{
+    const uint8_t *pui8In = (const uint8_t *)pcIn;
+    char *pcStart = pcOut;
+    uint8_t ui8Class;
+
+    while(ui32Len != 0)
+    {
+        //
+        // Most values are plain text, so copy a whole word when none of its
+        // four bytes needs to be encoded.
+        //
+        if((ui32Len >= 4) &&
+           ((g_pui8URLEncodeClass[pui8In[0]] |
+             g_pui8URLEncodeClass[pui8In[1]] |
+             g_pui8URLEncodeClass[pui8In[2]] |
+             g_pui8URLEncodeClass[pui8In[3]]) == URL_COPY))
+        {
+            memcpy(pcOut, pui8In, 4);
+            pcOut += 4;
+            pui8In += 4;
+            ui32Len -= 4;
+            continue;
+        }
+
+        ui8Class = g_pui8URLEncodeClass[*pui8In];
+        if(ui8Class == URL_COPY)
+        {
+            *pcOut++ = *pui8In;
+        }
+        else if(ui8Class == URL_PLUS)
+        {
+            *pcOut++ = '+';
+        }
+        else
+        {
+            *pcOut++ = '%';
+            *pcOut++ = g_pcURLHexDigits[*pui8In >> 4];
+            *pcOut++ = g_pcURLHexDigits[*pui8In & 0xF];
+        }
+        pui8In++;
+        ui32Len--;
+    }
+
+    return (pcOut - pcStart);
+}
+
+//*****************************************************************************
+//
+// URL decodes the first ui32Len bytes of pcBuf in place.  '+' becomes a
+// space and %XX escapes become the byte they encode.  A '%' that is not
+// followed by two hex digits is kept as it is.  The output is 0 terminated,
+// so pcBuf must hold ui32Len + 1 bytes.  Returns the length of the output.
+//
+//*****************************************************************************
+uint32_t
+URLDecode(char *pcBuf, uint32_t ui32Len)
+{
+    const uint8_t *pui8In = (const uint8_t *)pcBuf;
+    const uint8_t *pui8End = pui8In + ui32Len;
+    uint8_t *pui8Out = (uint8_t *)pcBuf;
+    uint8_t ui8Hi, ui8Lo;
+
+    while(pui8In < pui8End)
+    {
+        //
+        // Move a whole word when none of its four bytes is '%' or '+'.
+        //
+        if(((pui8End - pui8In) >= 4) &&
+           !((g_pui8URLDecodeClass[pui8In[0]] |
+              g_pui8URLDecodeClass[pui8In[1]] |
+              g_pui8URLDecodeClass[pui8In[2]] |
+              g_pui8URLDecodeClass[pui8In[3]]) & URL_SPECIAL))
+        {
+            memmove(pui8Out, pui8In, 4);
+            pui8Out += 4;
+            pui8In += 4;
+            continue;
+        }
+
+        if(*pui8In == '+')
+        {
+            *pui8Out++ = ' ';
+            pui8In++;
+        }
+        else if((*pui8In == '%') && ((pui8End - pui8In) >= 3) &&
+                !((ui8Hi = g_pui8URLDecodeClass[pui8In[1]]) &
+                  (URL_SPECIAL | URL_NOT_HEX)) &&
+                !((ui8Lo = g_pui8URLDecodeClass[pui8In[2]]) &
+                  (URL_SPECIAL | URL_NOT_HEX)))
+        {
+            *pui8Out++ = (ui8Hi << 4) | ui8Lo;
+            pui8In += 3;
+        }
+        else
+        {
+            *pui8Out++ = *pui8In++;
+        }
+    }
+
+    *pui8Out = '\0';
+
+    return (pui8Out - (uint8_t *)pcBuf);
+}
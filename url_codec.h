@@ -0,0 +1,38 @@
+//*****************************************************************************
+//
+// url_codec.h - Table driven URL encoding and decoding.
+//
+// Copyright (c) 2015 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+//
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+//
+//*****************************************************************************
+
+
+
+#ifndef __URL_CODEC_H__
+#define __URL_CODEC_H__
+
+//*****************************************************************************
+//
+// Prototypes of the functions that are called from outside the url_codec.c
+// module.
+//
+//*****************************************************************************
+extern uint32_t URLEncodedLength(const char *pcIn, uint32_t ui32Len);
+extern uint32_t URLEncode(char *pcOut, const char *pcIn, uint32_t ui32Len);
+extern uint32_t URLDecode(char *pcBuf, uint32_t ui32Len);
+
+#endif // __URL_CODEC_H__